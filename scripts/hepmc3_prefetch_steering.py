@@ -0,0 +1,34 @@
+"""
+npsim steering file: read HepMC3 ASCII input with HEPMC3PrefetchReader, which
+parses events in background threads ahead of the Geant4 workers.
+
+    NPSIM_PREFETCH_INPUT=events.hepmc3 npsim --steeringFile hepmc3_prefetch_steering.py ...
+
+NPSIM_PREFETCH_THREADS (default 2) and NPSIM_PREFETCH_DEPTH (default 64) set
+the number of parsing threads and of events kept ready. Do not pass the same
+file with --inputFiles as well.
+
+--skipNEvents is passed on as the input action's Sync. If the file has a
+current index (npdet_hepmc3_index events.hepmc3), the reader seeks straight to
+the first event instead of scanning for it.
+"""
+import os
+
+from DDSim.DD4hepSimulation import DD4hepSimulation
+
+SIM = DD4hepSimulation()
+
+
+def prefetch(dd4hepSimulation):
+  from DDG4 import GeneratorAction, Kernel
+  gen = GeneratorAction(Kernel(), "Geant4InputAction/HepMC3Prefetch", True)
+  gen.Input = "HEPMC3PrefetchReader|" + os.environ["NPSIM_PREFETCH_INPUT"]
+  gen.Parameters = {
+    "Threads": os.environ.get("NPSIM_PREFETCH_THREADS", "2"),
+    "Depth": os.environ.get("NPSIM_PREFETCH_DEPTH", "64"),
+  }
+  gen.Sync = dd4hepSimulation.skipNEvents
+  return gen
+
+
+SIM.inputConfig.userInputPlugin = [prefetch]
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Multi-threaded scaling benchmark for npsim.
+
+Runs the same event sample with an increasing number of Geant4 worker threads
+and reports the event throughput, the speedup over one thread and the parallel
+efficiency (speedup / threads).
+
+Start-up (geometry and physics initialization) does not scale with threads and
+would hide the event-loop scaling. For every thread count the benchmark
+therefore runs twice: once with one event per thread, and once with the full
+sample. The throughput is computed from the difference of the two wall times.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def run_npsim(args, threads, events, workdir):
+    cmd = [
+        args.npsim,
+        '--compactFile', args.compact,
+        '-N', str(events),
+        args.threads_option, str(threads),
+        '--random.seed', '1',
+        '--outputFile', os.path.join(workdir, 'sim_{}_{}.edm4hep.root'.format(threads, events)),
+        '-v', 'WARNING',
+    ]
+    if args.input:
+        cmd += ['--inputFiles', args.input]
+    if args.steering:
+        cmd += ['--steeringFile', args.steering]
+    if not args.input and not args.steering:
+        cmd += ['-G',
+                '--gun.particle', args.particle,
+                '--gun.momentumMin', args.momentum,
+                '--gun.momentumMax', args.momentum,
+                '--gun.distribution', 'uniform']
+    cmd += args.extra
+    start = time.monotonic()
+    result = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    elapsed = time.monotonic() - start
+    if result.returncode != 0:
+        print(result.stderr, file=sys.stderr)
+        raise RuntimeError('npsim failed with exit code {}: {}'.format(result.returncode, ' '.join(cmd)))
+    return elapsed
+
+
+if __name__ == '__main__':
+    detector = os.path.join(os.environ.get('DETECTOR_PATH', ''), os.environ.get('DETECTOR_CONFIG', 'epic') + '.xml')
+    parser = argparse.ArgumentParser(
+            description='Measure the multi-threaded scaling of npsim on a fixed event sample. '
+                        'Extra arguments after "--" are passed to npsim.')
+    parser.add_argument('--npsim', default='npsim', help='npsim executable')
+    parser.add_argument('--compact', default=detector, help='compact detector description')
+    parser.add_argument('--input', default=None, help='input file (default: particle gun, unless --steering is given)')
+    parser.add_argument('--steering', default=None,
+                        help='steering file, e.g. one that sets up its own input (default: none)')
+    parser.add_argument('--particle', default='pi-', help='gun particle')
+    parser.add_argument('--momentum', default='10*GeV', help='gun momentum')
+    parser.add_argument('-N', '--events', type=int, default=640, help='number of events in the sample')
+    parser.add_argument('--threads', default='1,2,4,8,16,32,64', help='comma-separated thread counts')
+    parser.add_argument('--threads-option', default='--numberOfThreads',
+                        help='npsim option that sets the number of worker threads')
+    parser.add_argument('extra', nargs='*', help='extra npsim arguments')
+    args = parser.parse_args()
+
+    thread_counts = [int(n) for n in args.threads.split(',')]
+    rows = []
+    with tempfile.TemporaryDirectory(prefix='npsim_mt_scaling_') as workdir:
+        for threads in thread_counts:
+            if args.events <= threads:
+                print('Skipping {} threads: need more than {} events'.format(threads, threads), file=sys.stderr)
+                continue
+            t_startup = run_npsim(args, threads, threads, workdir)
+            t_full = run_npsim(args, threads, args.events, workdir)
+            rate = (args.events - threads) / max(t_full - t_startup, 1e-9)
+            rows.append((threads, t_startup, t_full, rate))
+            print('{:>3} threads: {:.3f} events/s'.format(threads, rate), file=sys.stderr)
+
+    if not rows:
+        sys.exit(1)
+    base = rows[0][3] / rows[0][0]
+    print('{:>8} {:>12} {:>12} {:>12} {:>10} {:>10}'.format(
+        'threads', 'startup [s]', 'total [s]', 'events/s', 'speedup', 'efficiency'))
+    for threads, t_startup, t_full, rate in rows:
+        speedup = rate / base
+        print('{:>8} {:>12.1f} {:>12.1f} {:>12.3f} {:>10.2f} {:>10.2f}'.format(
+            threads, t_startup, t_full, rate, speedup, speedup / threads))
@@ -0,0 +1,105 @@
+// Microbenchmark: per-photon efficiency lookup of OpticalPhotonEfficiencyStackingAction.
+//
+// Compares the former evaluation (lambda from the photon energy, step and
+// floor/llround recomputed per photon) with npdet::sim::QuantumEfficiencyCurve
+// on the hpDIRC curve from npsim.py, and reports the largest difference.
+//
+// Usage: qe_curve_benchmark [photons]
+
+#include "npdet/QuantumEfficiencyCurve.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // h*c in eV*nm
+  constexpr double hc = 1239.84198;
+
+  /// Former evaluation, as in classifyNewTrack before the efficiency curve
+  double legacy(double energy, double lambda_min, double lambda_max, const std::vector<double>& efficiency) {
+    double lambda = hc / energy;
+    if (!(lambda_min < lambda && lambda < lambda_max)) return -1.;
+    double lambda_step = (lambda_max - lambda_min) / (efficiency.size() - 1);
+    double div = (lambda - lambda_min) / lambda_step;
+    auto i = std::llround(std::floor(div));
+    double t = div - i;
+    double a = efficiency[i];
+    double b = efficiency[i+1];
+    return a + t * (b - a);
+  }
+
+  template <typename F>
+  double time_ns(const std::vector<double>& energies, F&& f, double& sum) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const double e : energies) {
+      sum += f(e);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / energies.size();
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+  const double lambda_min = 180., lambda_max = 678.;
+  std::vector<double> efficiency = {
+    0,    0,    14.0, 14.8, 14.5, 14.9, 14.4, 14.2, 13.9, 14.6, 15.2, 15.7, 16.4, 16.9, 17.5,
+    17.7, 18.1, 18.8, 19.3, 19.8, 20.6, 21.4, 22.4, 23.1, 23.6, 24.1, 24.2, 24.6, 24.8, 25.2,
+    25.7, 26.5, 27.1, 28.2, 29.0, 29.9, 30.8, 31.1, 31.7, 31.8, 31.6, 31.5, 31.5, 31.3, 31.0,
+    30.8, 30.8, 30.4, 30.2, 30.3, 30.2, 30.1, 30.1, 30.1, 29.8, 29.9, 29.8, 29.7, 29.7, 29.7,
+    29.8, 29.8, 29.9, 29.9, 29.8, 29.9, 29.8, 29.9, 29.8, 29.7, 29.8, 29.7, 29.8, 29.6, 29.5,
+    29.7, 29.7, 29.8, 30.1, 30.4, 31.0, 31.3, 31.5, 31.8, 31.8, 31.9, 32.0, 32.0, 32.0, 32.0,
+    32.2, 32.2, 32.1, 31.8, 31.8, 31.8, 31.7, 31.6, 31.6, 31.7, 31.5, 31.5, 31.4, 31.3, 31.3,
+    31.2, 30.8, 30.7, 30.5, 30.3, 29.9, 29.5, 29.3, 29.2, 28.6, 28.2, 27.9, 27.8, 27.3, 27.0,
+    26.6, 26.1, 25.9, 25.5, 25.0, 24.6, 24.2, 23.8, 23.4, 23.0, 22.7, 22.4, 21.9, 21.4, 21.2,
+    20.7, 20.3, 19.8, 19.6, 19.3, 18.9, 18.7, 18.3, 17.9, 17.8, 17.8, 16.7, 16.5, 16.4, 16.0,
+    15.6, 15.6, 15.2, 14.9, 14.6, 14.4, 14.1, 13.8, 13.6, 13.3, 13.0, 12.8, 12.6, 12.3, 12.0,
+    11.9, 11.7, 11.5, 11.2, 11.1, 10.9, 10.7, 10.4, 10.3, 9.9,  9.8,  9.6,  9.3,  9.1,  9.0,
+    8.8,  8.5,  8.3,  8.3,  8.2,  7.9,  7.8,  7.7,  7.5,  7.3,  7.1,  6.9,  6.7,  6.6,  6.3,
+    6.2,  6.0,  5.8,  5.7,  5.6,  5.4,  5.2,  5.1,  4.9,  4.8,  4.6,  4.5,  4.4,  4.2,  4.1,
+    4.0,  3.8,  3.7,  3.5,  3.3,  3.2,  3.1,  3.0,  2.9,  2.5,  2.4,  2.4,  2.3,  2.3,  2.1,
+    1.8,  1.6,  1.5,  1.5,  1.6,  1.8,  1.9,  1.4,  0.8,  0.9,  0.8,  0.7,  0.6,  0.3,  0.3,
+    0.5,  0.3,  0.4,  0.3,  0.1,  0.2,  0.1,  0.2,  0.3,  0.0
+  };
+  for (auto& e : efficiency) e /= 100.;
+
+  const auto curve = npdet::sim::QuantumEfficiencyCurve::uniform(lambda_min, lambda_max, efficiency, hc);
+
+  // Photon energies inside the curve range, in random order as on the stack
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<double> dist(curve.energyMin(), curve.energyMax());
+  std::vector<double> energies(n);
+  for (auto& e : energies) e = dist(rng);
+
+  double max_diff = 0.;
+  for (std::size_t i = 0; i < std::min<std::size_t>(n, 1000000); ++i) {
+    const double e = energies[i];
+    if (curve.covers(e)) {
+      max_diff = std::max(max_diff, std::abs(curve(e) - legacy(e, lambda_min, lambda_max, efficiency)));
+    }
+  }
+
+  double sum = 0.;
+  const double t_legacy = time_ns(energies, [&](double e) {
+    return legacy(e, lambda_min, lambda_max, efficiency);
+  }, sum);
+  const double t_curve = time_ns(energies, [&](double e) {
+    return curve.covers(e) ? curve(e) : -1.;
+  }, sum);
+
+  std::printf("photons:                %zu\n", n);
+  std::printf("legacy interpolation:   %.2f ns/photon\n", t_legacy);
+  std::printf("QuantumEfficiencyCurve: %.2f ns/photon\n", t_curve);
+  std::printf("speedup:                %.2f\n", t_legacy / t_curve);
+  std::printf("max |difference|:       %.2e\n", max_diff);
+  std::printf("(checksum %g)\n", sum);
+  return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef NPDET_SIM_BACKGROUNDLIBRARY_H
+#define NPDET_SIM_BACKGROUNDLIBRARY_H
+
+// Framework include files
+#include "DDG4/Geant4InputHandling.h"
+
+// C/C++ include files
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npdet::sim {
+
+  /// Background events of a HepMC3 ASCII file, converted on demand for random access.
+  /**
+   *  The file is memory-mapped read-only and only the byte offsets of its
+   *  event records are kept, from the index written by npdet_hepmc3_index
+   *  (see HepMC3EventIndex) or, if there is no current index, from a scan
+   *  of the mapping. Drawing an event converts just that record, as
+   *  HEPMC3PrefetchReader does, so memory does not grow with the number of
+   *  events and pages of the file are shared by all threads. The library is
+   *  read-only after construction, so one instance is shared by all actions
+   *  and threads using the same file, see shared().
+   */
+  class BackgroundLibrary {
+  public:
+    /// Map and index the file, using the first max_events events (0: all); throws std::runtime_error on errors
+    BackgroundLibrary(const std::string& file, std::size_t max_events);
+    ~BackgroundLibrary();
+    BackgroundLibrary(const BackgroundLibrary&) = delete;
+    BackgroundLibrary& operator=(const BackgroundLibrary&) = delete;
+
+    /// Library for this file, shared by all callers that hold it
+    static std::shared_ptr<const BackgroundLibrary> shared(const std::string& file, std::size_t max_events);
+
+    /// Number of events
+    std::size_t size() const { return m_offsets.size() - 1; }
+
+    /// New interaction with the event, all particles and vertices tagged with mask; throws std::runtime_error
+    dd4hep::sim::Geant4PrimaryInteraction* interaction(std::size_t event, int mask) const;
+
+  private:
+    std::string                m_file;
+    const char*                m_data = nullptr;
+    std::size_t                m_size = 0;
+    /// Start of every event record, followed by the end of the last one
+    std::vector<std::uint64_t> m_offsets;
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_BACKGROUNDLIBRARY_H
@@ -0,0 +1,99 @@
+#ifndef DD4HEP_DDG4_EICInteractionAcceptanceFilter_H
+#define DD4HEP_DDG4_EICInteractionAcceptanceFilter_H
+
+/** \addtogroup GeneratorAction
+ * @{
+   \addtogroup EventFilter Event Filter
+ * \brief Drop events without final-state particles in the acceptance before tracking.
+ *
+ * Add it after the boost and smearing actions, so that the cuts apply in the
+ * detector frame, and before the interaction merger:
+ *
+ *     filter = DDG4.GeneratorAction(kernel, "EICInteractionAcceptanceFilter/Acceptance")
+ *     filter.EtaMin = -4.0
+ *     filter.EtaMax = 4.0
+ *     filter.PtMin = "0.2*GeV"
+ *     filter.PDG = [11, -11]
+ *     kernel.generatorAction().adopt(filter)
+ *
+ */
+
+// Framework include files
+#include "DDG4/Geant4GeneratorAction.h"
+
+#include "npdet/RunSummary.h"
+
+// C/C++ include files
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace npdet {
+  namespace sim {
+
+    using namespace dd4hep::sim;
+
+    /** Event filter on the final-state particles of the primary interactions.
+     *
+     * A final-state (generator status stable) particle is accepted if its
+     * pseudorapidity, momentum and transverse momentum are within the cuts
+     * and, if PDG is not empty, its PDG code is listed. An event passes if at
+     * least MinParticles particles are accepted. Otherwise all particles and
+     * vertices of the interactions are removed, so Geant4 has no primaries to
+     * track; the event itself is kept, with its number, in the output.
+     *
+     * Momenta are in DD4hep units. The pass rate over all instances with
+     * the same name (one per worker thread) is printed at the end of each
+     * run.
+     *
+     *  \ingroup GeneratorAction EventFilter EIC
+     */
+    class EICInteractionAcceptanceFilter: public Geant4GeneratorAction {
+    public:
+      /// Interaction definition
+      using Interaction = Geant4PrimaryInteraction;
+
+    protected:
+      /// Property: pseudorapidity range
+      double m_etaMin, m_etaMax;
+      /// Property: momentum range
+      double m_pMin, m_pMax;
+      /// Property: transverse momentum range
+      double m_ptMin, m_ptMax;
+      /// Property: accepted PDG codes (empty: all)
+      std::vector<int> m_pdg;
+      /// Property: minimum number of accepted particles
+      int m_minParticles;
+      /// Property: Unique identifier of the interaction to be filtered (-1: all)
+      int m_mask;
+
+      /// Number of events seen and passed in the run, shared by all instances with the same name
+      struct Counts {
+        std::atomic<std::size_t> events{0}, passed{0};
+      };
+      std::shared_ptr<RunSummary<Counts>> m_counts;
+
+      /// Number of accepted final-state particles of the interaction
+      int accepted(const Interaction* interaction) const;
+      /// Remove all particles and vertices of the interaction
+      static void clear(Interaction* interaction);
+
+    public:
+      /// Inhibit default constructor
+      EICInteractionAcceptanceFilter() = delete;
+      /// Inhibit copy constructor
+      EICInteractionAcceptanceFilter(const EICInteractionAcceptanceFilter& copy) = delete;
+      /// Standard constructor
+      EICInteractionAcceptanceFilter(Geant4Context* context, const std::string& name);
+      /// Default destructor
+      virtual ~EICInteractionAcceptanceFilter();
+      /// End-of-run callback: print the pass rate
+      void endRun(const G4Run* run);
+      /// Callback to generate primary particles
+      virtual void operator()(G4Event* event);
+    };
+  }    // End namespace sim
+}      // End namespace dd4hep
+
+//@}
+#endif /* DD4HEP_DDG4_EICInteractionAcceptanceFilter_H  */
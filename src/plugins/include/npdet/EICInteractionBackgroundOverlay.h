@@ -0,0 +1,121 @@
+#ifndef DD4HEP_DDG4_EICInteractionBackgroundOverlay_H
+#define DD4HEP_DDG4_EICInteractionBackgroundOverlay_H
+
+/** \addtogroup GeneratorAction
+ * @{
+   \addtogroup Overlay Background Overlay
+ * \brief Add background interactions from a DDG4 event reader to the signal interaction.
+ *
+ * One action per background source, added after the signal input and before
+ * the interaction merger:
+ *
+ *     bg = DDG4.GeneratorAction(kernel, "EICInteractionBackgroundOverlay/BeamGas")
+ *     bg.Input = "beam_gas.hepmc3"
+ *     bg.Mean = 0.3
+ *     bg.CrossingMin = -10
+ *     bg.CrossingMax = 10
+ *     kernel.generatorAction().adopt(bg)
+ *
+ */
+
+// Framework include files
+#include "DDG4/Geant4GeneratorAction.h"
+#include "npdet/BackgroundLibrary.h"
+#include "npdet/RunSummary.h"
+
+// C/C++ include files
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace npdet {
+  namespace sim {
+
+    using namespace dd4hep::sim;
+
+    /** Overlay of background interactions from one source.
+     *
+     * Per event, the number of background interactions is drawn from a
+     * Poisson distribution with mean Mean (per event, i.e. integrated over
+     * the crossing window). Each is a random event of the source, shifted in
+     * time by k * BunchSpacing with the crossing k drawn uniformly from
+     * [CrossingMin, CrossingMax], and added as its own interaction with
+     * masks Mask, Mask + 1, ... so that vertex actions and the interaction
+     * merger treat it as any other input.
+     *
+     * Each source owns the s_maskStride = 100 masks [Mask, Mask + 100); at
+     * most 100 interactions are added per event. Unless Mask is set, source
+     * n (counting from 0, in the order the actions are created) gets
+     * Mask = s_maskBase + n * s_maskStride = 100 + 100 * n. At the start of
+     * the run the action stops the run if its masks overlap those of another
+     * source.
+     *
+     * The source is a HepMC3 ASCII file, of which the first MaxEvents events
+     * (0: all) are used. It is opened at the start of the run as a
+     * BackgroundLibrary that all actions and threads reading the same file
+     * share; drawing an event converts only that event record. Write an
+     * index with npdet_hepmc3_index to save the scan for the event records.
+     *
+     * The number of overlaid interactions over all threads is printed at the
+     * end of each run.
+     *
+     *  \ingroup GeneratorAction Overlay EIC
+     */
+    class EICInteractionBackgroundOverlay: public Geant4GeneratorAction {
+    public:
+      /// Interaction definition
+      using Interaction = Geant4PrimaryInteraction;
+      /// First mask of the sources without Mask property
+      static constexpr int s_maskBase = 100;
+      /// Number of masks of each source
+      static constexpr int s_maskStride = 100;
+
+    protected:
+      /// Property: background input, a HepMC3 ASCII file
+      std::string m_input;
+      /// Property: number of events used from the input (0: all)
+      int m_maxEvents;
+      /// Property: mean number of background interactions per event
+      double m_mean;
+      /// Property: time between bunch crossings
+      double m_bunchSpacing;
+      /// Property: range of crossings relative to the signal crossing
+      int m_crossingMin, m_crossingMax;
+      /// Property: mask of the first background interaction (-1: from the source number)
+      int m_mask;
+
+      /// Number of this source in the order the actions were created
+      int m_source = 0;
+      /// Mask of the first background interaction, set at the start of the run
+      int m_firstMask = 0;
+
+      /// Shared background events, opened at the start of the run
+      std::shared_ptr<const BackgroundLibrary> m_library;
+
+      /// Number of events and overlaid interactions in the run, shared by all instances with the same name
+      struct Counts {
+        std::atomic<std::size_t> events{0}, overlaid{0};
+      };
+      std::shared_ptr<RunSummary<Counts>> m_counts;
+
+    public:
+      /// Inhibit default constructor
+      EICInteractionBackgroundOverlay() = delete;
+      /// Inhibit copy constructor
+      EICInteractionBackgroundOverlay(const EICInteractionBackgroundOverlay& copy) = delete;
+      /// Standard constructor
+      EICInteractionBackgroundOverlay(Geant4Context* context, const std::string& name);
+      /// Default destructor
+      virtual ~EICInteractionBackgroundOverlay();
+      /// Begin-of-run callback: assign the masks and open the input
+      void beginRun(const G4Run* run);
+      /// End-of-run callback: print the number of overlaid interactions
+      void endRun(const G4Run* run);
+      /// Callback to generate primary particles
+      virtual void operator()(G4Event* event);
+    };
+  }    // End namespace sim
+}      // End namespace dd4hep
+
+//@}
+#endif /* DD4HEP_DDG4_EICInteractionBackgroundOverlay_H  */
@@ -0,0 +1,119 @@
+#ifndef DD4HEP_DDG4_EICInteractionVertexBeamEffects_H
+#define DD4HEP_DDG4_EICInteractionVertexBeamEffects_H
+
+/** \addtogroup GeneratorAction
+ * @{
+   \addtogroup VertexSmearing Vertex Smearing
+ * \brief Place the primary vertex according to the bunch overlap of the colliding beams.
+ *
+ * Here is an example of usage in python:
+ *
+ *     beam = DDG4.GeneratorAction(kernel, "EICInteractionVertexBeamEffects/BeamEffects")
+ *     beam.Mask = -1
+ *     beam.IonBunchLength = "6*cm"
+ *     kernel.generatorAction().adopt(beam)
+ *
+ */
+
+// Framework include files
+#include "DDG4/Geant4GeneratorAction.h"
+
+#include "npdet/RunSummary.h"
+
+// ROOT include files
+#include "Math/Vector4D.h"
+
+// C/C++ include files
+#include <atomic>
+#include <memory>
+
+namespace npdet {
+  namespace sim {
+
+    using namespace dd4hep::sim;
+
+    /** Vertex position and time from the overlap of the ion and electron bunches.
+     *
+     * Per interaction, the longitudinal positions z_h and z_e of the colliding
+     * ion and electron inside their bunches are drawn from Gaussians with the
+     * bunch lengths. They meet at z = (z_h + z_e) / 2 and t = (z_e - z_h) / (2c),
+     * which gives the time-z correlation of the vertex.
+     *
+     * Hourglass effect: the transverse beam sizes grow away from the focus as
+     * sigma(z) = sqrt(emittance * beta* * (1 + (z / beta*)^2)). The luminosity
+     * weight of z, 1 / sqrt((sx_h^2 + sx_e^2)(sy_h^2 + sy_e^2)), is applied by
+     * accept/reject against its maximum at z = 0. The transverse vertex position
+     * is drawn from the overlap of the two beams at that z, with width
+     * sigma_h * sigma_e / sqrt(sigma_h^2 + sigma_e^2).
+     *
+     * Crab crossing: with the bunches tilted by half the crossing angle, the
+     * collision point moves along x with the collision time,
+     * x += tan(alpha / 2) * c * t, which is the x-z correlation in the
+     * detector frame.
+     *
+     * The vertex is generated in the head-on frame of the beams and rotated
+     * into the detector frame with the same rotation as
+     * EICInteractionVertexBoost, then added to all vertices and particles of
+     * the interaction. Each interaction costs a few Gaussian draws and, with
+     * the default parameters, about 1.1 hourglass trials.
+     *
+     * Lengths are in DD4hep units, times in ns. The defaults are the
+     * 275 GeV x 18 GeV configuration of the EIC CDR.
+     *
+     *  \ingroup GeneratorAction VertexSmearing EIC
+     */
+    class EICInteractionVertexBeamEffects: public Geant4GeneratorAction {
+    public:
+      /// Interaction definition
+      using Interaction = Geant4PrimaryInteraction;
+
+    protected:
+      /// Property: RMS bunch lengths
+      double m_ionBunchLength;
+      double m_eBunchLength;
+      /// Property: beta* in x and y
+      double m_ionBetaStarX, m_ionBetaStarY;
+      double m_eBetaStarX, m_eBetaStarY;
+      /// Property: RMS emittances in x and y
+      double m_ionEmittanceX, m_ionEmittanceY;
+      double m_eEmittanceX, m_eEmittanceY;
+      /// Property: Crossing angles relative to central B-field solenoid.
+      double m_ionCrossingAngle;
+      double m_eCrossingAngle;
+      /// Property: apply the crab-crossing x-t correlation
+      bool m_crabCrossing;
+      /// Property: apply the hourglass effect
+      bool m_hourglass;
+      /// Property: constant shift (x, y, z, t) of the vertex
+      ROOT::Math::XYZTVector m_offset = {0, 0, 0, 0};
+      /// Property: Unique identifier of the interaction to be modified
+      int m_mask;
+
+      /// Number of interactions and hourglass trials in the run, shared by all instances with the same name
+      struct Counts {
+        std::atomic<std::size_t> interactions{0}, trials{0};
+      };
+      std::shared_ptr<RunSummary<Counts>> m_counts;
+
+      /// Draw the vertex (x, y, z, t) of one interaction, in Geant4 units
+      ROOT::Math::XYZTVector sampleVertex();
+
+    public:
+      /// Inhibit default constructor
+      EICInteractionVertexBeamEffects() = delete;
+      /// Inhibit copy constructor
+      EICInteractionVertexBeamEffects(const EICInteractionVertexBeamEffects& copy) = delete;
+      /// Standard constructor
+      EICInteractionVertexBeamEffects(Geant4Context* context, const std::string& name);
+      /// Default destructor
+      virtual ~EICInteractionVertexBeamEffects();
+      /// End-of-run callback: print the hourglass acceptance
+      void endRun(const G4Run* run);
+      /// Callback to generate primary particles
+      virtual void operator()(G4Event* event);
+    };
+  }    // End namespace sim
+}      // End namespace dd4hep
+
+//@}
+#endif /* DD4HEP_DDG4_EICInteractionVertexBeamEffects_H  */
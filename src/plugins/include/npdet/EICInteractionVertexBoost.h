@@ -19,6 +19,9 @@
 // Framework include files
 #include "DDG4/Geant4GeneratorAction.h"
 
+#include "npdet/LorentzTransform.h"
+#include "npdet/SummaryHistograms.h"
+
 namespace npdet {
 
   namespace sim {
@@ -44,9 +47,25 @@ namespace npdet {
       double m_eCrossingAngle   = 0.00833333;
       /// Property: Unique identifier of the interaction to be modified
       int m_mask;
+      /// Property: ROOT file for the per-run summary histograms (empty: no summary)
+      std::string m_summaryFile;
+
+      /// Crossing-angle transformation, cached for the angles it was computed for
+      LorentzTransform m_transform;
+      double m_cachedIonCrossingAngle = 0.0, m_cachedECrossingAngle = 0.0;
+      bool   m_transformValid = false;
+      /// Scratch four-vectors for the transformation
+      FourVectorBatch m_batch;
+
+      /// Recompute the crossing-angle transformation if the angle properties changed
+      void updateTransform();
+
+      /// Summary histograms of the applied boosts
+      SummaryHistograms m_summary;
+      std::size_t m_hDeltaTheta = 0;
 
       /// Action routine to boost one single interaction according to the properties
-      void boost(Interaction* interaction)  const;
+      void boost(Interaction* interaction);
 
     public:
       /// Inhibit default constructor
@@ -55,6 +74,8 @@ namespace npdet {
       EICInteractionVertexBoost(Geant4Context* context, const std::string& name);
       /// Default destructor
       virtual ~EICInteractionVertexBoost();
+      /// End-of-run callback: write the summary histograms of all instances
+      void endRun(const G4Run* run);
       /// Callback to generate primary particles
       virtual void operator()(G4Event* event);
     };
@@ -0,0 +1,88 @@
+#ifndef DD4HEP_DDG4_EICInteractionVertexBoostSmear_H
+#define DD4HEP_DDG4_EICInteractionVertexBoostSmear_H
+
+/** \addtogroup GeneratorAction
+ * @{
+   \addtogroup VertexBoosting Vertex Boost
+ * \brief Crossing-angle boost, beam-divergence smearing and vertex offset in one pass.
+ *
+ * Here is an example of usage in python:
+ *
+ *     boostsmear = DDG4.GeneratorAction(kernel, "EICInteractionVertexBoostSmear/BoostSmear")
+ *     boostsmear.Mask = -1
+ *     boostsmear.VertexOffset = (0, 0, 0, 0)
+ *     kernel.generatorAction().adopt(boostsmear)
+ *
+ */
+
+// Framework include files
+#include "DDG4/Geant4GeneratorAction.h"
+
+#include "npdet/LorentzTransform.h"
+
+// ROOT include files
+#include "Math/LorentzRotation.h"
+#include "Math/Vector4D.h"
+
+namespace npdet {
+  namespace sim {
+
+    using namespace dd4hep::sim;
+
+    /// Action class replacing EICInteractionVertexSmear followed by EICInteractionVertexBoost
+    /**
+     * The per-event beam-divergence rotation (as EICInteractionVertexSmear),
+     * the crossing-angle boost (as EICInteractionVertexBoost) and a constant
+     * vertex offset are composed into one 4x4 matrix per event and applied
+     * in a single pass over the vertices and particles of the interaction.
+     * The crossing-angle boost depends only on the properties and is composed
+     * once, not per event.
+     *
+     *  \ingroup GeneratorAction VertexBoosting VertexSmearing EIC
+     */
+    class EICInteractionVertexBoostSmear: public Geant4GeneratorAction {
+    public:
+      /// Interaction definition
+      using Interaction = Geant4PrimaryInteraction;
+
+    protected:
+      /// Property: Crossing angles relative to central B-field solenoid.
+      double m_ionCrossingAngle = 0.0166667;
+      double m_eCrossingAngle   = 0.00833333;
+      /// Property: mean divergence angles (x, y), as Offset of EICInteractionVertexSmear
+      ROOT::Math::PxPyPzEVector m_offset = {0, 0, 0, 0};
+      /// Property: sigma_x,y of the ion beam divergence in units of angle.
+      ROOT::Math::PxPyPzEVector m_sigma_Ion = {0.000103, 0.000195, 0.0, 0.0};
+      /// Property: constant shift (x, y, z, t) of all vertices after the transformation
+      ROOT::Math::XYZTVector m_vertexOffset = {0, 0, 0, 0};
+      /// Property: Unique identifier of the interaction to be modified
+      int m_mask;
+
+      /// Crossing-angle boost and the angles it was computed for
+      ROOT::Math::LorentzRotation m_crossing;
+      double m_cachedIonCrossingAngle = 0.0, m_cachedECrossingAngle = 0.0;
+      /// Scratch four-vectors for the transformation
+      FourVectorBatch m_batch;
+
+      /// Crossing-angle boost, recomputed only when the angles changed
+      const ROOT::Math::LorentzRotation& crossing();
+      /// Per-event beam-divergence rotation
+      ROOT::Math::LorentzRotation divergence() const;
+
+    public:
+      /// Inhibit default constructor
+      EICInteractionVertexBoostSmear() = delete;
+      /// Inhibit copy constructor
+      EICInteractionVertexBoostSmear(const EICInteractionVertexBoostSmear& copy) = delete;
+      /// Standard constructor
+      EICInteractionVertexBoostSmear(Geant4Context* context, const std::string& name);
+      /// Default destructor
+      virtual ~EICInteractionVertexBoostSmear();
+      /// Callback to generate primary particles
+      virtual void operator()(G4Event* event);
+    };
+  }    // End namespace sim
+}      // End namespace dd4hep
+
+//@}
+#endif /* DD4HEP_DDG4_EICInteractionVertexBoostSmear_H  */
@@ -0,0 +1,83 @@
+#ifndef DD4HEP_DDG4_EICInteractionVertexDistribution_H
+#define DD4HEP_DDG4_EICInteractionVertexDistribution_H
+
+/** \addtogroup GeneratorAction
+ * @{
+   \addtogroup VertexSmearing Vertex Smearing
+ * \brief Place the primary vertex according to a tabulated (x, y, z, t) distribution.
+ *
+ * Here is an example of usage in python:
+ *
+ *     vtx = DDG4.GeneratorAction(kernel, "EICInteractionVertexDistribution/VertexTable")
+ *     vtx.Mask = -1
+ *     vtx.File = "vertex_275x18.bin"
+ *     kernel.generatorAction().adopt(vtx)
+ *
+ */
+
+// Framework include files
+#include "DDG4/Geant4GeneratorAction.h"
+#include "npdet/VertexDistribution.h"
+
+// ROOT include files
+#include "Math/Vector4D.h"
+
+// C/C++ include files
+#include <memory>
+
+namespace npdet {
+  namespace sim {
+
+    using namespace dd4hep::sim;
+
+    /** Vertex position and time sampled from a binned 4D distribution.
+     *
+     * For vertex distributions that are not a product of Gaussians, for
+     * example from a beam-beam simulation, the distribution is read from a
+     * binned file (see VertexDistribution for the format) and sampled with
+     * an alias table: one table lookup per interaction, independent of the
+     * number of bins. The vertex is uniform within the selected bin.
+     *
+     * The table is built and validated at the beginning of the run. All
+     * instances reading the same file, in particular the copies in the worker
+     * threads, share one read-only table.
+     *
+     * The file is in Geant4 units (mm, ns); the Offset is in DD4hep units.
+     *
+     *  \ingroup GeneratorAction VertexSmearing EIC
+     */
+    class EICInteractionVertexDistribution: public Geant4GeneratorAction {
+    public:
+      /// Interaction definition
+      using Interaction = Geant4PrimaryInteraction;
+
+    protected:
+      /// Property: binned vertex distribution file
+      std::string m_file;
+      /// Property: constant shift (x, y, z, t) of the vertex
+      ROOT::Math::XYZTVector m_offset = {0, 0, 0, 0};
+      /// Property: Unique identifier of the interaction to be modified
+      int m_mask;
+
+      /// Shared sampling table, loaded at the beginning of the run
+      std::shared_ptr<const VertexDistribution> m_table;
+
+    public:
+      /// Inhibit default constructor
+      EICInteractionVertexDistribution() = delete;
+      /// Inhibit copy constructor
+      EICInteractionVertexDistribution(const EICInteractionVertexDistribution& copy) = delete;
+      /// Standard constructor
+      EICInteractionVertexDistribution(Geant4Context* context, const std::string& name);
+      /// Default destructor
+      virtual ~EICInteractionVertexDistribution();
+      /// Begin-of-run callback: load and validate the distribution
+      void beginRun(const G4Run* run);
+      /// Callback to generate primary particles
+      virtual void operator()(G4Event* event);
+    };
+  }    // End namespace sim
+}      // End namespace dd4hep
+
+//@}
+#endif /* DD4HEP_DDG4_EICInteractionVertexDistribution_H  */
@@ -13,6 +13,8 @@
 // Framework include files
 #include "DDG4/Geant4GeneratorAction.h"
 
+#include "npdet/SummaryHistograms.h"
+
 // ROOT include files
 #include "Math/Vector4D.h"
 
@@ -44,9 +46,15 @@ namespace npdet {
       ROOT::Math::PxPyPzEVector m_sigma_Electron = {0.000215, 0.000156, 0.0, 0.0};
       /// Property: Unique identifier of the interaction created
       int m_mask;
+      /// Property: ROOT file for the per-run summary histograms (empty: no summary)
+      std::string m_summaryFile;
+
+      /// Summary histograms of the applied rotations
+      SummaryHistograms m_summary;
+      std::size_t m_hDx = 0, m_hDy = 0, m_hAlpha = 0;
 
       /// Action routine to smear one single interaction according to the properties
-      void smear(Interaction* interaction)  const;
+      void smear(Interaction* interaction);
       
     public:
       /// Inhibit default constructor
@@ -57,6 +65,8 @@ namespace npdet {
       EICInteractionVertexSmear(Geant4Context* context, const std::string& name);
       /// Default destructor
       virtual ~EICInteractionVertexSmear();
+      /// End-of-run callback: write the summary histograms of all instances
+      void endRun(const G4Run* run);
       /// Callback to generate primary particles
       virtual void operator()(G4Event* event);
     };
@@ -0,0 +1,24 @@
+#ifndef NPDET_SIM_GENERATORSTATUS_H
+#define NPDET_SIM_GENERATORSTATUS_H
+
+// Framework include files
+#include "DDG4/Geant4Particle.h"
+
+namespace npdet::sim {
+
+  /// Set the G4PARTICLE_GEN_* bit of a particle from its HepMC generator status
+  inline void setGeneratorStatus(dd4hep::sim::Geant4Particle& p) {
+    dd4hep::sim::PropertyMask status(p.status);
+    switch (p.genStatus) {
+    case 0:  status.set(G4PARTICLE_GEN_EMPTY);         break;
+    case 1:  status.set(G4PARTICLE_GEN_STABLE);        break;
+    case 2:  status.set(G4PARTICLE_GEN_DECAYED);       break;
+    case 3:  status.set(G4PARTICLE_GEN_DOCUMENTATION); break;
+    case 4:  status.set(G4PARTICLE_GEN_BEAM);          break;
+    default: status.set(G4PARTICLE_GEN_OTHER);         break;
+    }
+  }
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_GENERATORSTATUS_H
@@ -0,0 +1,129 @@
+#ifndef NPDET_SIM_HEPMC3PREFETCHREADER_H
+#define NPDET_SIM_HEPMC3PREFETCHREADER_H
+
+// Framework include files
+#include "DDG4/Geant4InputAction.h"
+
+// C/C++ include files
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace npdet::sim {
+
+  using namespace dd4hep::sim;
+
+  /// HepMC3 ASCII reader that parses events ahead of time in background threads.
+  /**
+   *  The input action calls its reader under a lock shared by all worker
+   *  threads, so with a reader that parses on demand the workers queue up
+   *  behind the parsing. This reader memory-maps the file and parses the
+   *  next events in a pool of background threads into a bounded ring of
+   *  ready vertex and particle lists, in file order. readParticles() then
+   *  only hands over the lists of the next slot.
+   *
+   *  Events are converted as by the HepMC3 reader of DDG4: particle ids are
+   *  the file ids minus one, every particle without parents gets its own
+   *  vertex, and the generator status is mapped to the G4PARTICLE_GEN_* bits.
+   *  As in scripts/sanitize_hepmc3.py, an event record without a position
+   *  takes the position of the first vertex that has one; particles without
+   *  a production vertex start there.
+   *
+   *  Events skipped at the start of the job (npsim --skipNEvents, passed as
+   *  the input action's Sync property) are not parsed. If the file has a
+   *  current index written by npdet_hepmc3_index, the reader starts directly
+   *  at the first event; otherwise it scans for the event records.
+   *
+   *  The file is parsed directly from the mapping, so only uncompressed
+   *  HepMC3 ASCII (Asciiv3) files are supported.
+   *
+   *  Parameters (Geant4InputAction.Parameters):
+   *    - Threads: number of parsing threads (default 2)
+   *    - Depth:   number of events kept ready (default 64)
+   *
+   *  Usage in a steering file:
+   *
+   *      def prefetch(dd4hepSimulation):
+   *        from DDG4 import GeneratorAction, Kernel
+   *        gen = GeneratorAction(Kernel(), "Geant4InputAction/HepMC3Prefetch", True)
+   *        gen.Input = "HEPMC3PrefetchReader|events.hepmc3"
+   *        gen.Parameters = {"Threads": "4", "Depth": "128"}
+   *        gen.Sync = dd4hepSimulation.skipNEvents
+   *        return gen
+   *
+   *      SIM.inputConfig.userInputPlugin = [prefetch]
+   *
+   *  scripts/hepmc3_prefetch_steering.py does this for the file in
+   *  NPSIM_PREFETCH_INPUT.
+   */
+  class HEPMC3PrefetchReader : public Geant4EventReader {
+  public:
+    /// Converted event, or the reason it could not be converted
+    struct Event {
+      Vertices    vertices;
+      Particles   particles;
+      std::string error;
+      bool        ready = false;
+    };
+
+  protected:
+    /// Parameters
+    std::size_t m_threads = 2;
+    std::size_t m_depth   = 64;
+
+    /// File mapping and the position of the next unclaimed event record
+    const char* m_data   = nullptr;
+    std::size_t m_size   = 0;
+    const char* m_cursor = nullptr;
+    const char* m_end    = nullptr;
+    /// Events to pass over before parsing starts
+    std::size_t m_skip = 0;
+    /// Error opening the file, reported by the first read
+    std::string m_openError;
+
+    /// Ring of events; event number n is in slot n % m_depth
+    std::vector<Event>      m_ring;
+    std::size_t             m_claimed  = 0;
+    std::size_t             m_consumed = 0;
+    bool                    m_stop     = false;
+    std::mutex              m_lock;
+    std::condition_variable m_cond;
+    std::vector<std::thread> m_pool;
+
+    /// Map the file and start the parsing threads
+    void start();
+    /// Parsing thread: claim the next event record, convert it, mark its slot ready
+    void work();
+    /// Release all particles and vertices of an event
+    static void clear(Event& event);
+
+  public:
+    /// Initializing constructor
+    explicit HEPMC3PrefetchReader(const std::string& nam);
+    /// Default destructor
+    virtual ~HEPMC3PrefetchReader();
+    /// Read Threads and Depth
+    virtual EventReaderStatus setParameters(std::map<std::string, std::string>& parameters) override;
+    /// Skip the first events without parsing them
+    virtual EventReaderStatus moveToEvent(int event_number) override;
+    /// Drop the next event
+    virtual EventReaderStatus skipEvent() override;
+    /// Hand over the next event in file order
+    virtual EventReaderStatus readParticles(int event_number, Vertices& vertices, Particles& particles) override;
+
+    /// Convert one event record (from its E line to the next one); returns the error, empty on success
+    /**
+     *  Depends only on the text, so any thread can convert records located
+     *  with a HepMC3EventIndex, see BackgroundLibrary.
+     */
+    static std::string convert(std::string_view record, Vertices& vertices, Particles& particles);
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_HEPMC3PREFETCHREADER_H
@@ -0,0 +1,106 @@
+#ifndef NPDET_SIM_HEPMC3EVENTINDEX_H
+#define NPDET_SIM_HEPMC3EVENTINDEX_H
+
+// C/C++ include files
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// POSIX include files
+#include <sys/stat.h>
+
+namespace npdet::sim {
+
+  /// Byte offsets of the event records of a HepMC3 ASCII file, stored next to it as <file>.idx.
+  /**
+   *  Index file format (native byte order):
+   *
+   *      char     magic[8]     "NPHMC3IX"
+   *      uint32   version      1
+   *      uint32   reserved     0
+   *      uint64   file_size    size of the indexed file
+   *      int64    file_mtime   modification time of the indexed file [s]
+   *      uint64   n_events
+   *      uint64   offset[n_events]
+   *
+   *  The index is written by npdet_hepmc3_index. Readers use it only if the
+   *  size and modification time still match the file, so a stale index is
+   *  ignored rather than used.
+   */
+  struct HepMC3EventIndex {
+    std::uint64_t              file_size  = 0;
+    std::int64_t               file_mtime = 0;
+    std::vector<std::uint64_t> offsets;
+
+    static constexpr char          magic[8] = {'N', 'P', 'H', 'M', 'C', '3', 'I', 'X'};
+    static constexpr std::uint32_t version  = 1;
+
+    /// Sidecar index file name of a HepMC3 file
+    static std::string path(const std::string& file) { return file + ".idx"; }
+
+    /// Index the event records of the file contents in memory
+    static HepMC3EventIndex build(const char* data, std::size_t size) {
+      HepMC3EventIndex index;
+      index.file_size = size;
+      const std::string_view text(data, size);
+      if (!text.empty() && text.front() == 'E') index.offsets.push_back(0);
+      for (std::size_t pos = text.find("\nE"); pos != std::string_view::npos; pos = text.find("\nE", pos + 2)) {
+        index.offsets.push_back(pos + 1);
+      }
+      return index;
+    }
+
+    /// Size and modification time of a file; false if it cannot be accessed
+    static bool file_status(const std::string& file, std::uint64_t& size, std::int64_t& mtime) {
+      struct ::stat st;
+      if (::stat(file.c_str(), &st) != 0) return false;
+      size  = st.st_size;
+      mtime = st.st_mtime;
+      return true;
+    }
+
+    /// Write the index to idx_file; false on I/O errors
+    bool write(const std::string& idx_file) const {
+      std::FILE* out = std::fopen(idx_file.c_str(), "wb");
+      if (!out) return false;
+      const std::uint32_t head[2] = {version, 0};
+      const std::uint64_t n       = offsets.size();
+      bool ok = std::fwrite(magic, sizeof(magic), 1, out) == 1 && std::fwrite(head, sizeof(head), 1, out) == 1 &&
+                std::fwrite(&file_size, sizeof(file_size), 1, out) == 1 &&
+                std::fwrite(&file_mtime, sizeof(file_mtime), 1, out) == 1 && std::fwrite(&n, sizeof(n), 1, out) == 1 &&
+                std::fwrite(offsets.data(), sizeof(std::uint64_t), n, out) == n;
+      ok = std::fclose(out) == 0 && ok;
+      return ok;
+    }
+
+    /// Read the index of a HepMC3 file from its sidecar; false if missing, invalid or stale
+    static bool load(const std::string& file, HepMC3EventIndex& index) {
+      std::uint64_t size  = 0;
+      std::int64_t  mtime = 0;
+      if (!file_status(file, size, mtime)) return false;
+      std::FILE* in = std::fopen(path(file).c_str(), "rb");
+      if (!in) return false;
+      char          head_magic[8];
+      std::uint32_t head[2];
+      std::uint64_t n = 0;
+      bool ok = std::fread(head_magic, sizeof(head_magic), 1, in) == 1 &&
+                std::memcmp(head_magic, magic, sizeof(magic)) == 0 && std::fread(head, sizeof(head), 1, in) == 1 &&
+                head[0] == version && std::fread(&index.file_size, sizeof(index.file_size), 1, in) == 1 &&
+                std::fread(&index.file_mtime, sizeof(index.file_mtime), 1, in) == 1 &&
+                std::fread(&n, sizeof(n), 1, in) == 1 && index.file_size == size && index.file_mtime == mtime &&
+                n <= size;
+      if (ok) {
+        index.offsets.resize(n);
+        ok = std::fread(index.offsets.data(), sizeof(std::uint64_t), n, in) == n;
+      }
+      std::fclose(in);
+      return ok;
+    }
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_HEPMC3EVENTINDEX_H
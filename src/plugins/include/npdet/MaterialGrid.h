@@ -0,0 +1,206 @@
+#ifndef NPDET_MAT_MATERIALGRID_H
+#define NPDET_MAT_MATERIALGRID_H
+
+// C/C++ include files
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// POSIX include files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace npdet::mat {
+
+  /// Header of a material grid file
+  struct MaterialGridHeader {
+    char          magic[8]      = {'N', 'P', 'M', 'A', 'T', 'G', 'R', 'D'};
+    std::uint32_t version       = 1;
+    std::uint32_t nbins[3]      = {0, 0, 0};
+    std::uint32_t samples       = 0;
+    std::uint32_t reserved      = 0;
+    std::uint64_t geometry_hash = 0;
+    double        lo[3]         = {0, 0, 0};
+    double        hi[3]         = {0, 0, 0};
+
+    std::size_t size() const { return std::size_t(nbins[0]) * nbins[1] * nbins[2]; }
+    /// True for a valid header of the current version
+    bool valid() const {
+      const MaterialGridHeader ref;
+      return std::memcmp(magic, ref.magic, sizeof(magic)) == 0 && version == ref.version && size() > 0 &&
+             lo[0] < hi[0] && lo[1] < hi[1] && lo[2] < hi[2];
+    }
+    /// Same geometry and grid
+    bool same_grid(const MaterialGridHeader& other) const {
+      return geometry_hash == other.geometry_hash && samples == other.samples &&
+             std::equal(nbins, nbins + 3, other.nbins) && std::equal(lo, lo + 3, other.lo) &&
+             std::equal(hi, hi + 3, other.hi);
+    }
+  };
+  static_assert(sizeof(MaterialGridHeader) == 88, "material grid header layout");
+
+  /// Material of a detector averaged over a regular (x, y, z) grid of voxels.
+  /**
+   *  File format (native byte order):
+   *
+   *      MaterialGridHeader                "NPMATGRD", version 1, bins in x, y, z,
+   *                                        sub-samples per voxel side, geometry
+   *                                        hash, lower and upper grid edges [cm]
+   *      float    inv_x0[nx*ny*nz]         voxel average of 1/X0 [1/cm]
+   *      float    inv_lambda[nx*ny*nz]     voxel average of 1/lambda [1/cm]
+   *                                        index (ix * ny + iy) * nz + iz
+   *
+   *  Grids are written by npdet_mat_grid, which names them after the hash of
+   *  the geometry they were built from, so a cached grid is only reused for
+   *  the same geometry. The file is memory-mapped read-only; one instance can
+   *  be shared by any number of threads.
+   *
+   *  integrate() walks the voxels along a line (Amanatides-Woo traversal)
+   *  and sums the exact path length in each voxel times its averaged 1/X0
+   *  and 1/lambda. Material outside of the grid is not counted.
+   */
+  class MaterialGrid {
+  public:
+    /// Integrated material along a line inside the grid
+    struct Budget {
+      double x0     = 0; // X/X0
+      double lambda = 0; // lambda/lambda0
+      double length = 0; // path length inside the grid [cm]
+    };
+
+    /// Map a grid file; throws std::runtime_error if it cannot be read or is not a grid file
+    explicit MaterialGrid(const std::string& path) {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("MaterialGrid: cannot open " + path);
+      }
+      struct ::stat st;
+      if (::fstat(fd, &st) == 0 && std::size_t(st.st_size) >= sizeof(MaterialGridHeader)) {
+        m_size = st.st_size;
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        m_data = data == MAP_FAILED ? nullptr : data;
+      }
+      ::close(fd);
+      if (!m_data) {
+        throw std::runtime_error("MaterialGrid: cannot map " + path);
+      }
+      std::memcpy(&m_header, m_data, sizeof(m_header));
+      if (!m_header.valid() || m_size != sizeof(m_header) + 2 * m_header.size() * sizeof(float)) {
+        ::munmap(m_data, m_size);
+        throw std::runtime_error("MaterialGrid: " + path + " is not a material grid file");
+      }
+      m_inv_x0     = reinterpret_cast<const float*>(static_cast<const char*>(m_data) + sizeof(m_header));
+      m_inv_lambda = m_inv_x0 + m_header.size();
+      for (int a = 0; a < 3; ++a) {
+        m_width[a] = (m_header.hi[a] - m_header.lo[a]) / m_header.nbins[a];
+      }
+    }
+    MaterialGrid(const MaterialGrid&)            = delete;
+    MaterialGrid& operator=(const MaterialGrid&) = delete;
+    ~MaterialGrid() { ::munmap(m_data, m_size); }
+
+    /// Header of a grid file without mapping it; false if missing or invalid
+    static bool read_header(const std::string& path, MaterialGridHeader& header) {
+      std::FILE* in = std::fopen(path.c_str(), "rb");
+      if (!in) return false;
+      bool ok = std::fread(&header, sizeof(header), 1, in) == 1 && header.valid();
+      std::fclose(in);
+      return ok;
+    }
+
+    /// Write a grid file; false on I/O errors
+    static bool write(const std::string& path, const MaterialGridHeader& header, const float* inv_x0,
+                      const float* inv_lambda) {
+      std::FILE* out = std::fopen(path.c_str(), "wb");
+      if (!out) return false;
+      const std::size_t n = header.size();
+      bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 && std::fwrite(inv_x0, sizeof(float), n, out) == n &&
+                std::fwrite(inv_lambda, sizeof(float), n, out) == n;
+      ok = std::fclose(out) == 0 && ok;
+      return ok;
+    }
+
+    const MaterialGridHeader& header() const { return m_header; }
+
+    /// Parameter range [t0, t1] of the line p0 + t * (p1 - p0), t in [0, 1], inside the grid; false if it misses
+    bool clip(const double p0[3], const double p1[3], double& t0, double& t1) const {
+      t0 = 0;
+      t1 = 1;
+      for (int a = 0; a < 3; ++a) {
+        const double d = p1[a] - p0[a];
+        if (d == 0) {
+          if (p0[a] < m_header.lo[a] || p0[a] >= m_header.hi[a]) return false;
+          continue;
+        }
+        double ta = (m_header.lo[a] - p0[a]) / d;
+        double tb = (m_header.hi[a] - p0[a]) / d;
+        if (ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+      }
+      return t0 < t1;
+    }
+
+    /// Integrated X/X0 and lambda/lambda0 between two points [cm]
+    Budget integrate(const double p0[3], const double p1[3]) const {
+      Budget budget;
+      double t0, t1;
+      if (!clip(p0, p1, t0, t1)) return budget;
+      const double d[3]   = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      const double length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+      const double inf    = std::numeric_limits<double>::infinity();
+
+      // Voxel of the entry point and the parameter of the next voxel boundary on each axis
+      int    index[3], step[3];
+      double t_max[3], t_delta[3];
+      for (int a = 0; a < 3; ++a) {
+        const double x = p0[a] + d[a] * t0;
+        index[a] = std::clamp(int(std::floor((x - m_header.lo[a]) / m_width[a])), 0, int(m_header.nbins[a]) - 1);
+        step[a]  = d[a] > 0 ? 1 : -1;
+        if (d[a] == 0) {
+          t_max[a]   = inf;
+          t_delta[a] = inf;
+        } else {
+          const double edge = m_header.lo[a] + (index[a] + (d[a] > 0 ? 1 : 0)) * m_width[a];
+          t_max[a]          = (edge - p0[a]) / d[a];
+          t_delta[a]        = m_width[a] / std::abs(d[a]);
+        }
+      }
+
+      const std::size_t ny = m_header.nbins[1], nz = m_header.nbins[2];
+      double            t  = t0;
+      while (t < t1) {
+        const int         a    = t_max[0] < t_max[1] ? (t_max[0] < t_max[2] ? 0 : 2) : (t_max[1] < t_max[2] ? 1 : 2);
+        const double      next = std::min(t_max[a], t1);
+        const double      seg  = (next - t) * length;
+        const std::size_t i    = (index[0] * ny + index[1]) * nz + index[2];
+        budget.x0 += seg * m_inv_x0[i];
+        budget.lambda += seg * m_inv_lambda[i];
+        budget.length += seg;
+        t = next;
+        index[a] += step[a];
+        if (index[a] < 0 || index[a] >= int(m_header.nbins[a])) break;
+        t_max[a] += t_delta[a];
+      }
+      return budget;
+    }
+
+  private:
+    MaterialGridHeader m_header;
+    void*              m_data       = nullptr;
+    std::size_t        m_size       = 0;
+    const float*       m_inv_x0     = nullptr;
+    const float*       m_inv_lambda = nullptr;
+    double             m_width[3]   = {0, 0, 0};
+  };
+
+} // namespace npdet::mat
+
+#endif // NPDET_MAT_MATERIALGRID_H
@@ -16,13 +16,22 @@
 #include "DDG4/Geant4Random.h"
 #include "DDG4/Geant4StackingAction.h"
 #include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
 #include "G4OpticalPhoton.hh"
 #include "G4Region.hh"
+#include "G4Run.hh"
 #include "G4Track.hh"
 
+#include "npdet/QuantumEfficiencyCurve.h"
+#include "npdet/RunFileName.h"
+#include "npdet/RunSummary.h"
+
 #include <map>
+#include <memory>
 #include <optional>
 #include <regex>
+#include <sstream>
+#include <vector>
 
 /// Namespace for the AIDA detector description toolkit
 namespace dd4hep {
@@ -30,6 +39,48 @@ namespace dd4hep {
   /// Namespace for the Geant4 based simulation part of the AIDA detector description toolkit
   namespace sim {
 
+    /// Stacking action that applies a wavelength-dependent detection efficiency to optical photons.
+    /**
+     *  The action carries a table of (volume/region matcher -> efficiency
+     *  curve) entries, so one instance serves all optical detectors:
+     *
+     *   - the LambdaMin, LambdaMax, Efficiency, LogicalVolume and Region
+     *     properties form the first entry (if either regex is set), with the
+     *     efficiency on a uniform wavelength grid;
+     *   - every string of the Curves property adds an entry
+     *       "name: lv=<regex> region=<regex> file=<path> scale=<factor>"
+     *     where the file holds two columns, wavelength in nm and efficiency
+     *     (times scale, e.g. 0.01 for percent), see
+     *     npdet::sim::QuantumEfficiencyCurve::fromFile. At least one of lv
+     *     and region is required; the regexes must not contain spaces.
+     *
+     *  A photon uses the first entry whose LogicalVolume regex matches the
+     *  name of its logical volume or whose Region regex matches the name of
+     *  its region. Photons outside the wavelength range of the curve are kept.
+     *
+     *  Thread safety: DDG4 creates one instance per worker thread, and all
+     *  mutable state (counters, compiled regexes) is owned by the instance.
+     *  The table is built in prepare(), once per event and only if the
+     *  properties changed, never in the per-photon path.
+     *
+     *  Volume matching: the regexes are evaluated once per logical volume when
+     *  the geometry or the table change. The matching entry and the photon
+     *  counters of a volume live in a dense array indexed by
+     *  G4LogicalVolume::GetInstanceID(), so the per-photon path is an array
+     *  access and a curve evaluation in photon energy (see
+     *  npdet::sim::QuantumEfficiencyCurve), without hashing or string
+     *  compares. The regex path only runs for volumes created after the
+     *  cache was built.
+     *
+     *  At the end of each run the counters of every instance are merged into
+     *  the totals of all instances with the same name (see
+     *  npdet::sim::RunSummary; the lock is taken once per thread and run).
+     *  The last instance to finish the run prints the totals and, if
+     *  ReportFile is set, writes the per-volume breakdown of the run: a TTree
+     *  "photons" for a .root file, a text table otherwise. Runs after the
+     *  first write to the report file name with the run id inserted before
+     *  the extension (see npdet::sim::runFileName).
+     */
     class OpticalPhotonEfficiencyStackingAction: public Geant4StackingAction {
     public:
       /// Standard constructor with initializing arguments
@@ -40,14 +91,19 @@ namespace dd4hep {
         declareProperty("Efficiency", m_efficiency);
         declareProperty("LogicalVolume", m_logical_volume);
         declareProperty("Region", m_region);
+        declareProperty("Curves", m_curves);
+        declareProperty("ReportFile", m_report_file);
+        m_summary = npdet::sim::RunSummary<Totals>::attach(this, &OpticalPhotonEfficiencyStackingAction::endRun);
       };
       /// Default destructor
       virtual ~OpticalPhotonEfficiencyStackingAction() {
-        printout(INFO, name(), "Suppressed %zu of %zu photons in lv regex %s or region regex %s",
+        m_summary->detach();
+      };
+      /// End-of-run callback: merge the counters of this run into the totals of all instances
+      void endRun(const G4Run* run) {
+        flush_entry_counts();
+        printout(DEBUG, name(), "Suppressed %zu of %zu photons in lv regex %s or region regex %s",
           m_killed_photons, m_total_photons, m_logical_volume.c_str(), m_region.c_str());
-        for (const auto& [lv, count] : m_unsuppressed_photons) {
-          printout(INFO, name(), "Unsuppressed photons in lv %s: %zu", lv.c_str(), count);
-        }
         printout(DEBUG, name(), "lambda range: [%f,%f] nm",
           m_lambda_min / CLHEP::nm, m_lambda_max / CLHEP::nm);
         std::ostringstream oss_efficiency;
@@ -55,113 +111,300 @@ namespace dd4hep {
           std::ostream_iterator<double>(oss_efficiency, " "));
         std::string str_efficiency = oss_efficiency.str();
         printout(DEBUG, name(), "efficiency: %s", str_efficiency.c_str());
+        m_summary->endOfRun([this](Totals& totals) { merge_into(totals); },
+                            [this, run](Totals& totals) { report(totals, run->GetRunID()); });
       };
       /// New-stage callback
       virtual void newStage(G4StackManager*) override { };
-      /// Preparation callback
-      virtual void prepare(G4StackManager*) override { };
+      /// Preparation callback, called before every event
+      virtual void prepare(G4StackManager*) override {
+        const bool changed = update_entries();
+        const auto* store = G4LogicalVolumeStore::GetInstance();
+        if (changed || store->size() != m_cached_store_size) {
+          for (auto& volume : m_volumes) {
+            volume.entry = nullptr;
+            volume.known = false;
+          }
+          for (const auto* lv : *store) {
+            volume_slot(lv);
+          }
+          m_cached_store_size = store->size();
+        }
+      };
       /// Return TrackClassification with enum G4ClassificationOfNewTrack or NoTrackClassification
       virtual TrackClassification classifyNewTrack(G4StackManager*, const G4Track* aTrack) override {
         // Only apply to optical photons
         if (aTrack->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
           auto* pv = aTrack->GetVolume();
           if (pv == nullptr) return TrackClassification();
-          auto* lv = pv->GetLogicalVolume();
-          auto* region = lv->GetRegion();
-          const auto& volume_name = lv->GetName();
-          const auto region_name = region == nullptr ? G4String{} : region->GetName();
-          update_regex_cache(m_logical_volume, m_cached_logical_volume, m_logical_volume_regex);
-          update_regex_cache(m_region, m_cached_region, m_region_regex);
-          printout(VERBOSE, name(), "photon in pv %s lv %s",
-            pv->GetName().c_str(), lv->GetName().c_str());
-          // Apply to matching logical volume or region regex
-          const bool volume_matches = m_logical_volume_regex && std::regex_search(volume_name, *m_logical_volume_regex);
-          const bool region_matches = m_region_regex && std::regex_search(region_name, *m_region_regex);
-          if (volume_matches || region_matches) {
-            double mom = aTrack->GetMomentum().mag();
-            double lambda = CLHEP::hbarc * CLHEP::twopi / mom;
-            printout(VERBOSE, name(), "with mom = %f eV, lambda = %f nm",
-              mom / CLHEP::eV, lambda / CLHEP::nm);
-
+          const auto* lv = pv->GetLogicalVolume();
+          auto& volume = volume_slot(lv);
+          volume.total++;
+          // Apply the curve of the first matching entry
+          if (auto* entry = volume.entry) {
             m_total_photons++;
-            if (m_lambda_min < lambda && lambda < m_lambda_max) {
-              double efficiency{0.};
-              if (m_efficiency.size() == 0) {
-                // No efficiency specified, assume zero
-                efficiency = 0.;
-                // which means kill
-                ++m_killed_photons;
-                return TrackClassification(fKill);
-
-              } else if (m_efficiency.size() == 1) {
-                // Single constant value over lambda range
-                efficiency = m_efficiency.front();
-
-              } else {
-                // Linear interpolation on lambda grid
-                double lambda_step = (m_lambda_max - m_lambda_min) / (m_efficiency.size() - 1);
-                double div = (lambda - m_lambda_min) / lambda_step;
-                auto i = std::llround(std::floor(div));
-                double t = div - i;
-                double a = m_efficiency[i];
-                double b = m_efficiency[i+1];
-                efficiency = a + t * (b - a);
-                printout(VERBOSE, name(), "a = %f, b = %f, t = %f", a, b, t);
-                printout(VERBOSE, name(), "efficiency %f", efficiency);
-              }
+            entry->total++;
+            // For optical photons the kinetic energy is the photon energy
+            const double energy = aTrack->GetKineticEnergy();
+            if (entry->curve.covers(energy)) {
+              const double efficiency = entry->curve(energy);
 
               // Edge cases
-              if (efficiency == 0.0) {
+              if (efficiency <= 0.0) {
                 ++m_killed_photons;
+                ++entry->killed;
+                ++volume.killed;
                 return TrackClassification(fKill);
               }
-              if (efficiency == 1.0) return TrackClassification();
+              if (efficiency >= 1.0) return TrackClassification();
 
               // Throw random value
               Geant4Event&  evt = context()->event();
               Geant4Random& rnd = evt.random();
-              double random = rnd.uniform();
-              if (random > efficiency) {
-                printout(VERBOSE, name(), "photon killed");
+              if (rnd.uniform() > efficiency) {
                 ++m_killed_photons;
+                ++entry->killed;
+                ++volume.killed;
                 return TrackClassification(fKill);
               }
-            } else {
-              printout(VERBOSE, name(), "outside lambda range [%f,%f] nm", m_lambda_min / CLHEP::nm, m_lambda_max / CLHEP::nm);
             }
-          } else {
-            m_unsuppressed_photons[volume_name]++;
-            printout(VERBOSE, name(), "no QE match for lv %s against %s or region %s against %s",
-              volume_name.c_str(), m_logical_volume.c_str(), region_name.c_str(), m_region.c_str());
           }
         }
         return TrackClassification();
       };
     private:
-      static void update_regex_cache(const std::string& expression, std::string& cached_expression,
-                                     std::optional<std::regex>& regex) {
-        if (expression.empty()) {
-          cached_expression = expression;
-          regex.reset();
-        } else if (expression != cached_expression) {
+      using QuantumEfficiencyCurve = npdet::sim::QuantumEfficiencyCurve;
+
+      /// One (volume/region matcher -> efficiency curve) entry
+      struct Entry {
+        std::string               name;
+        std::optional<std::regex> logical_volume_regex, region_regex;
+        QuantumEfficiencyCurve    curve;
+        std::size_t               total{0}, killed{0};
+      };
+
+      /// Entry and photon counters of one logical volume, indexed by its instance id
+      struct VolumeSlot {
+        Entry*      entry{nullptr};
+        bool        known{false};
+        std::size_t total{0}, killed{0};
+      };
+
+    public:
+      /// Job-wide photon counters of one logical volume, for the report
+      struct VolumeReport {
+        std::string curve;
+        std::size_t total{0}, killed{0};
+      };
+
+    private:
+      /// Totals of one run over all instances with the same name
+      struct Totals {
+        std::size_t                         total_photons{0}, killed_photons{0};
+        std::map<std::string, VolumeReport> volumes;
+        std::map<std::string, std::pair<std::size_t, std::size_t>> entries;
+      };
+
+      /// Move the counters of this instance into the totals of the run
+      void merge_into(Totals& totals) {
+        totals.total_photons  += m_total_photons;
+        totals.killed_photons += m_killed_photons;
+        m_total_photons = m_killed_photons = 0;
+        for (std::size_t id = 0; id < m_volumes.size(); ++id) {
+          auto& volume = m_volumes[id];
+          if (volume.total == 0) continue;
+          auto& report = totals.volumes[m_volume_names[id]];
+          if (volume.entry != nullptr) report.curve = volume.entry->name;
+          report.total  += volume.total;
+          report.killed += volume.killed;
+          volume.total = volume.killed = 0;
+        }
+        for (const auto& [entry, counts] : m_entry_counts) {
+          totals.entries[entry].first  += counts.first;
+          totals.entries[entry].second += counts.second;
+        }
+        m_entry_counts.clear();
+      }
+
+      /// Print the totals of the run and write the report if ReportFile is set
+      void report(const Totals& totals, int run) const {
+        if (!m_report_file.empty()) {
+          const auto file = npdet::sim::runFileName(m_report_file, run);
+          write_report(file, totals.volumes);
+          printout(INFO, name(), "Wrote per-volume photon report to %s", file.c_str());
+        }
+        printout(INFO, name(), "Suppressed %zu of %zu photons", totals.killed_photons, totals.total_photons);
+        for (const auto& [entry, counts] : totals.entries) {
+          if (totals.entries.size() < 2) break;
+          printout(INFO, name(), "Suppressed %zu of %zu photons for curve %s",
+            counts.second, counts.first, entry.c_str());
+        }
+        for (const auto& [lv, volume] : totals.volumes) {
+          if (!volume.curve.empty()) continue;
+          printout(INFO, name(), "Unsuppressed photons in lv %s: %zu", lv.c_str(), volume.total);
+        }
+      }
+
+      /// Move the per-entry counters into m_entry_counts
+      void flush_entry_counts() {
+        for (auto& entry : m_entries) {
+          auto& counts = m_entry_counts[entry.name];
+          counts.first  += entry.total;
+          counts.second += entry.killed;
+          entry.total = entry.killed = 0;
+        }
+      }
+
+      /// Rebuild the entry table if any of its properties changed; returns true if it did
+      bool update_entries() {
+        if (m_lambda_min == m_cached_lambda_min && m_lambda_max == m_cached_lambda_max &&
+            m_efficiency == m_cached_efficiency && m_logical_volume == m_cached_logical_volume &&
+            m_region == m_cached_region && m_curves == m_cached_curves && m_entries_built) {
+          return false;
+        }
+        m_cached_lambda_min     = m_lambda_min;
+        m_cached_lambda_max     = m_lambda_max;
+        m_cached_efficiency     = m_efficiency;
+        m_cached_logical_volume = m_logical_volume;
+        m_cached_region         = m_region;
+        m_cached_curves         = m_curves;
+        m_entries_built         = true;
+
+        flush_entry_counts();
+        m_entries.clear();
+        m_entries.reserve(m_curves.size() + 1);
+        if (!m_logical_volume.empty() || !m_region.empty()) {
+          Entry& entry = m_entries.emplace_back();
+          entry.name                 = name();
+          entry.logical_volume_regex = compile_regex(m_logical_volume);
+          entry.region_regex         = compile_regex(m_region);
+          // An empty range leaves the curve empty: no photon is inside, none is suppressed
+          if (0. < m_lambda_min && m_lambda_min < m_lambda_max) {
+            entry.curve = QuantumEfficiencyCurve::uniform(m_lambda_min, m_lambda_max, m_efficiency,
+                                                          CLHEP::hbarc * CLHEP::twopi);
+          }
+        }
+        for (const auto& spec : m_curves) {
           try {
-            regex.emplace(expression, std::regex_constants::ECMAScript | std::regex_constants::optimize);
-            cached_expression = expression;
-          } catch (const std::regex_error& e) {
-            cached_expression = expression;
-            regex.reset();
-            printout(ERROR, "OpticalPhotonEfficiencyStackingAction", "Invalid regex '%s': %s", expression.c_str(), e.what());
+            m_entries.push_back(parse_entry(spec));
+          } catch (const std::exception& e) {
+            except("Invalid efficiency curve '%s': %s", spec.c_str(), e.what());
+          }
+        }
+        for (const auto& entry : m_entries) {
+          printout(DEBUG, name(), "Curve %s: energy range [%f,%f] eV, maximum efficiency %f",
+            entry.name.c_str(), entry.curve.energyMin() / CLHEP::eV, entry.curve.energyMax() / CLHEP::eV,
+            entry.curve.maximum());
+        }
+        return true;
+      }
+
+      /// Parse one entry of the Curves property
+      static Entry parse_entry(const std::string& spec) {
+        const auto colon = spec.find(':');
+        if (colon == std::string::npos) {
+          throw std::invalid_argument("no 'name:' prefix");
+        }
+        Entry entry;
+        std::istringstream(spec.substr(0, colon)) >> entry.name;
+        if (entry.name.empty()) {
+          throw std::invalid_argument("empty name");
+        }
+        std::string file;
+        double      scale = 1.0;
+        bool        matcher = false;
+        std::istringstream tokens(spec.substr(colon + 1));
+        std::string        token;
+        while (tokens >> token) {
+          const auto eq = token.find('=');
+          if (eq == std::string::npos || eq == 0 || eq + 1 == token.size()) {
+            throw std::invalid_argument("expected key=value, got '" + token + "'");
+          }
+          const std::string key   = token.substr(0, eq);
+          const std::string value = token.substr(eq + 1);
+          if (key == "lv") {
+            entry.logical_volume_regex.emplace(value, std::regex_constants::ECMAScript | std::regex_constants::optimize);
+            matcher = true;
+          } else if (key == "region") {
+            entry.region_regex.emplace(value, std::regex_constants::ECMAScript | std::regex_constants::optimize);
+            matcher = true;
+          } else if (key == "file") {
+            file = value;
+          } else if (key == "scale") {
+            scale = std::stod(value);
+          } else {
+            throw std::invalid_argument("unknown key '" + key + "'");
+          }
+        }
+        if (!matcher || file.empty()) {
+          throw std::invalid_argument("need file= and at least one of lv= and region=");
+        }
+        entry.curve = QuantumEfficiencyCurve::fromFile(file, CLHEP::nm, scale, CLHEP::hbarc * CLHEP::twopi);
+        return entry;
+      }
+
+      /// First entry matching one logical volume by the LogicalVolume and Region regexes, or nullptr
+      Entry* match_volume(const G4LogicalVolume* lv) {
+        const auto* region = lv->GetRegion();
+        const auto region_name = region == nullptr ? G4String{} : region->GetName();
+        for (auto& entry : m_entries) {
+          if ((entry.logical_volume_regex && std::regex_search(lv->GetName(), *entry.logical_volume_regex)) ||
+              (entry.region_regex && std::regex_search(region_name, *entry.region_regex))) {
+            return &entry;
           }
         }
+        return nullptr;
+      }
+
+      /// Slot of one logical volume; runs the regexes for volumes not seen since the last rebuild
+      VolumeSlot& volume_slot(const G4LogicalVolume* lv) {
+        const auto id = static_cast<std::size_t>(lv->GetInstanceID());
+        if (id >= m_volumes.size()) {
+          m_volumes.resize(id + 1);
+          m_volume_names.resize(id + 1);
+        }
+        auto& volume = m_volumes[id];
+        if (!volume.known) {
+          volume.entry       = match_volume(lv);
+          volume.known       = true;
+          m_volume_names[id] = lv->GetName();
+        }
+        return volume;
+      }
+
+      /// Write the per-volume breakdown: a TTree for .root files, a text table otherwise
+      static void write_report(const std::string& file, const std::map<std::string, VolumeReport>& volumes);
+
+      /// Compile a regex; an empty or invalid expression matches nothing
+      std::optional<std::regex> compile_regex(const std::string& expression) const {
+        if (expression.empty()) {
+          return std::nullopt;
+        }
+        try {
+          return std::regex(expression, std::regex_constants::ECMAScript | std::regex_constants::optimize);
+        } catch (const std::regex_error& e) {
+          printout(ERROR, name(), "Invalid regex '%s': %s", expression.c_str(), e.what());
+          return std::nullopt;
+        }
       }
 
       double m_lambda_min{0.}, m_lambda_max{0.};
       std::vector<double> m_efficiency;
       std::string m_logical_volume, m_region;
+      std::vector<std::string> m_curves;
+      double m_cached_lambda_min{0.}, m_cached_lambda_max{0.};
+      std::vector<double> m_cached_efficiency;
       std::string m_cached_logical_volume, m_cached_region;
-      std::optional<std::regex> m_logical_volume_regex, m_region_regex;
+      std::vector<std::string> m_cached_curves;
+      bool m_entries_built{false};
+      std::vector<Entry> m_entries;
+      std::vector<VolumeSlot> m_volumes;
+      std::vector<std::string> m_volume_names;
+      std::string m_report_file;
+      std::size_t m_cached_store_size{0};
       std::size_t m_total_photons{0}, m_killed_photons{0};
-      std::map<std::string, std::size_t> m_unsuppressed_photons;
+      std::map<std::string, std::pair<std::size_t, std::size_t>> m_entry_counts;
+      std::shared_ptr<npdet::sim::RunSummary<Totals>> m_summary;
     };
   }    // End namespace sim
 }      // End namespace dd4hep
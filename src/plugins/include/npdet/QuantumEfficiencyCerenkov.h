@@ -0,0 +1,64 @@
+#ifndef NPDET_SIM_QUANTUMEFFICIENCYCERENKOV_H
+#define NPDET_SIM_QUANTUMEFFICIENCYCERENKOV_H
+
+// Geant4 include files
+#include "G4Cerenkov.hh"
+
+#include "npdet/QuantumEfficiencyCurve.h"
+
+// C/C++ include files
+#include <optional>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class G4LogicalVolume;
+
+namespace npdet::sim {
+
+  /// Cerenkov process that applies a photon detection efficiency at generation time.
+  /**
+   *  In logical volumes matching the LogicalVolume or Region regex, the mean
+   *  number of Cerenkov photons is scaled by the maximum efficiency, and each
+   *  sampled photon is accepted with probability efficiency(lambda) / maximum.
+   *  Rejected photons are never allocated as G4DynamicParticle/G4Track. The
+   *  accepted photons follow the same spectrum and count distribution as the
+   *  photons that would survive OpticalPhotonEfficiencyStackingAction, except
+   *  that photons outside [LambdaMin, LambdaMax] are treated as efficiency 0.
+   *
+   *  Everywhere else the standard G4Cerenkov generation is used.
+   *
+   *  The efficiency curve uses the same conventions as
+   *  OpticalPhotonEfficiencyStackingAction: a uniform grid in wavelength from
+   *  lambda_min to lambda_max, linearly interpolated. It is evaluated in the
+   *  photon energy (see QuantumEfficiencyCurve).
+   */
+  class QuantumEfficiencyCerenkov : public G4Cerenkov {
+  public:
+    QuantumEfficiencyCerenkov(const G4String& name, double lambda_min, double lambda_max,
+                              const std::vector<double>& efficiency, const std::string& logical_volume,
+                              const std::string& region);
+    ~QuantumEfficiencyCerenkov() override = default;
+
+    /// Generate the (efficiency-weighted) Cerenkov photons of one step
+    G4VParticleChange* PostStepDoIt(const G4Track& aTrack, const G4Step& aStep) override;
+
+    /// Efficiency curve in photon energy
+    const QuantumEfficiencyCurve& curve() const { return m_curve; }
+    /// Maximum of the efficiency curve
+    double maxEfficiency() const { return m_max_efficiency; }
+
+  private:
+    /// True if the efficiency applies to photons generated in this logical volume
+    bool appliesTo(const G4LogicalVolume* lv);
+
+    QuantumEfficiencyCurve    m_curve;
+    double                    m_max_efficiency{0.};
+    std::optional<std::regex> m_logical_volume_regex, m_region_regex;
+    std::unordered_map<const G4LogicalVolume*, bool> m_volume_matches;
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_QUANTUMEFFICIENCYCERENKOV_H
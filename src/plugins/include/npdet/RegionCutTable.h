@@ -0,0 +1,71 @@
+#ifndef NPDET_SIM_REGIONCUTTABLE_H
+#define NPDET_SIM_REGIONCUTTABLE_H
+
+// C/C++ include files
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace npdet::sim {
+
+  /// Table of (r,z) regions, each with its own particle-dropping thresholds.
+  /**
+   *  A region is a ring rmin <= r < rmax, zmin <= z < zmax around the z axis,
+   *  with a minimum momentum, a minimum kinetic energy and an optional list of
+   *  PDG codes it applies to. Regions may overlap; the first region in
+   *  declaration order that matches the particle wins.
+   *
+   *  After compile(), the region boundaries are indexed as a 2D grid of
+   *  candidate lists, so a lookup is two binary searches plus a scan of the
+   *  (usually one or two) regions covering that grid cell.
+   *
+   *  The table itself is unit agnostic; lengths and energies are compared in
+   *  whatever units the regions were filled with.
+   */
+  class RegionCutTable {
+  public:
+    /// One region and its thresholds
+    struct Region {
+      std::string      name;
+      double           zmin{-std::numeric_limits<double>::infinity()};
+      double           zmax{std::numeric_limits<double>::infinity()};
+      double           rmin{0.};
+      double           rmax{std::numeric_limits<double>::infinity()};
+      double           momentumMin{0.};  ///< Drop particles with |p| below this value
+      double           energyMin{0.};    ///< Drop particles with kinetic energy below this value
+      std::vector<int> pdg;              ///< PDG codes the region applies to, sorted; empty for all
+
+      /// True if the region applies to particles of this PDG code
+      bool appliesTo(int pdg_code) const;
+    };
+
+    /// Parse a region specification of the form
+    ///   "name: zmin=590*cm zmax=680*cm rmax=30*cm pmin=50*MeV ekinmin=10*MeV pdg=22,2112"
+    /// Values are DD4hep expressions evaluated in DD4hep units; all keys are optional.
+    static Region parse(const std::string& spec);
+
+    /// Append a region (lowest priority so far); invalidates the index
+    void add(Region region);
+    /// Remove all regions
+    void clear();
+    /// Build the (r,z) index
+    void compile();
+
+    /// First region applicable to a particle of this PDG code ending at (r,z), or nullptr
+    const Region* find(double r, double z, int pdg_code) const;
+
+    bool                       empty() const { return m_regions.empty(); }
+    const std::vector<Region>& regions() const { return m_regions; }
+
+  private:
+    std::vector<Region>        m_regions;
+    std::vector<double>        m_zEdges;       ///< Sorted region z boundaries, with +-inf sentinels
+    std::vector<double>        m_rEdges;       ///< Sorted region r boundaries, with 0 and +inf sentinels
+    std::vector<std::uint32_t> m_cellBegin;    ///< Offsets into m_cellRegions, one per cell plus one
+    std::vector<std::uint16_t> m_cellRegions;  ///< Region indices covering each cell, by priority
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_REGIONCUTTABLE_H
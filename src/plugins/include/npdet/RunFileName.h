@@ -0,0 +1,31 @@
+#ifndef NPDET_SIM_RUNFILENAME_H
+#define NPDET_SIM_RUNFILENAME_H
+
+// C/C++ include files
+#include <string>
+
+namespace npdet::sim {
+
+  /// Output file name for the summary of one run.
+  /**
+   *  Summaries are written at the end of every run, so files of later runs
+   *  would overwrite the first one. For runs after the first the run id is
+   *  inserted before the extension ("summary.json" becomes
+   *  "summary.run1.json"); the name of run 0 is returned unchanged.
+   */
+  inline std::string runFileName(const std::string& name, int run) {
+    if (run <= 0) {
+      return name;
+    }
+    const std::string tag   = ".run" + std::to_string(run);
+    const auto        slash = name.find_last_of('/');
+    const auto        dot   = name.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+      return name + tag;
+    }
+    return name.substr(0, dot) + tag + name.substr(dot);
+  }
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_RUNFILENAME_H
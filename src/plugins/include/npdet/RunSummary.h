@@ -0,0 +1,102 @@
+#ifndef NPDET_SIM_RUNSUMMARY_H
+#define NPDET_SIM_RUNSUMMARY_H
+
+// Framework include files
+#include "DDG4/Geant4Action.h"
+#include "DDG4/Geant4Kernel.h"
+#include "DDG4/Geant4RunAction.h"
+
+// C/C++ include files
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class G4Run;
+
+namespace npdet::sim {
+
+  /// Totals of all instances of an action with the same name, reported once per run.
+  /**
+   *  DDG4 creates one instance of an action per worker thread. Each instance
+   *  attaches to the summary of its name when it is constructed, which also
+   *  registers its end-of-run callback with the run action sequence of its
+   *  thread. At the end of the run every instance merges its results into
+   *  the shared totals; the last one to do so reports them and resets them
+   *  for the next run. In multi-threaded mode DDG4 has no run action sequence
+   *  on the master thread, so this is the point at which all workers have
+   *  finished the run; in sequential mode it is the end of the run itself.
+   *
+   *  Instances with different names (e.g. two configurations of the same
+   *  action) have separate totals.
+   *
+   *  Usage, with Totals default constructible:
+   *
+   *      m_summary = RunSummary<Totals>::attach(this, &MyAction::endRun);
+   *      ...
+   *      void MyAction::endRun(const G4Run*) {
+   *        m_summary->endOfRun([&](Totals& totals) { ...add this instance... },
+   *                            [&](Totals& totals) { ...report... });
+   *      }
+   */
+  template <typename Totals>
+  class RunSummary {
+  public:
+    /// Summary shared by the instances named like action; registers callback at the end of each run
+    template <typename Action>
+    static std::shared_ptr<RunSummary> attach(Action* action, void (Action::*callback)(const G4Run*)) {
+      static std::mutex                                        lock;
+      static std::map<std::string, std::weak_ptr<RunSummary>> registry;
+      std::shared_ptr<RunSummary>                              summary;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        auto& entry = registry[action->name()];
+        summary     = entry.lock();
+        if (!summary) {
+          summary = std::make_shared<RunSummary>();
+          entry   = summary;
+        }
+      }
+      {
+        std::lock_guard<std::mutex> guard(summary->m_lock);
+        ++summary->m_instances;
+      }
+      action->context()->kernel().runAction().callAtEnd(action, callback);
+      return summary;
+    }
+
+    RunSummary() : m_totals(std::make_unique<Totals>()) {}
+
+    /// Stop counting an instance, e.g. from its destructor
+    void detach() {
+      std::lock_guard<std::mutex> guard(m_lock);
+      --m_instances;
+    }
+
+    /// Totals of the current run, for instances that add to them while the run is going on
+    Totals& totals() { return *m_totals; }
+
+    /// Merge one instance's results with merge(totals); the last instance of the run calls report(totals)
+    template <typename Merge, typename Report>
+    void endOfRun(Merge&& merge, Report&& report) {
+      std::lock_guard<std::mutex> guard(m_lock);
+      merge(*m_totals);
+      if (++m_finished < m_instances) {
+        return;
+      }
+      report(*m_totals);
+      m_totals   = std::make_unique<Totals>();
+      m_finished = 0;
+    }
+
+  private:
+    std::mutex              m_lock;
+    std::unique_ptr<Totals> m_totals;
+    std::size_t             m_instances = 0;
+    std::size_t             m_finished  = 0;
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_RUNSUMMARY_H
@@ -0,0 +1,108 @@
+#ifndef NPDET_SIM_SUMMARYHISTOGRAMS_H
+#define NPDET_SIM_SUMMARYHISTOGRAMS_H
+
+// Framework include files
+#include "DD4hep/Printout.h"
+
+#include "npdet/RunFileName.h"
+#include "npdet/RunSummary.h"
+
+// ROOT include files
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1D.h"
+#include "TROOT.h"
+
+// C/C++ include files
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npdet::sim {
+
+  /// Per-run summary histograms of an action, written to a ROOT file at the end of the run.
+  /**
+   *  Replaces per-event printouts: the action fills a histogram with every
+   *  value it applies. At the end of the run the histograms of all instances
+   *  of the action (one per worker thread) are added up and written once, by
+   *  the last instance to finish the run (see RunSummary); runs after the
+   *  first write to the file name with the run id inserted (see
+   *  runFileName).
+   *
+   *  The histograms are created with no current directory, so they never
+   *  attach to a directory of another thread, and are owned by the action.
+   *  ROOT's thread safety is enabled when the first summary is created.
+   */
+  class SummaryHistograms {
+  public:
+    /// Histograms of one run added up over all instances of an action
+    struct Totals {
+      std::vector<std::unique_ptr<TH1D>> histograms;
+    };
+
+    SummaryHistograms() { ROOT::EnableThreadSafety(); }
+
+    /// Register callback of action at the end of each run, which has to call endOfRun
+    template <typename Action>
+    void attach(Action* action, void (Action::*callback)(const G4Run*)) {
+      m_run = RunSummary<Totals>::attach(action, callback);
+    }
+    /// Stop counting the action, from its destructor
+    void detach() {
+      if (m_run) m_run->detach();
+    }
+
+    /// Book a histogram; returns the index to fill
+    std::size_t book(const std::string& name, const std::string& title, int bins, double lo, double hi) {
+      TDirectory::TContext detached(nullptr);
+      m_histograms.emplace_back(std::make_unique<TH1D>(name.c_str(), title.c_str(), bins, lo, hi));
+      return m_histograms.size() - 1;
+    }
+    /// Fill a booked histogram
+    void fill(std::size_t index, double value) { m_histograms[index]->Fill(value); }
+    /// True if nothing was booked
+    bool empty() const { return m_histograms.empty(); }
+
+    /// Add the histograms of this run to the totals and reset them; the last instance writes the totals to file
+    void endOfRun(const std::string& file, int run, const std::string& caller) {
+      m_run->endOfRun(
+          [this](Totals& totals) {
+            TDirectory::TContext detached(nullptr);
+            for (std::size_t i = 0; i < m_histograms.size(); ++i) {
+              if (i < totals.histograms.size()) {
+                totals.histograms[i]->Add(m_histograms[i].get());
+              } else {
+                totals.histograms.emplace_back(static_cast<TH1D*>(m_histograms[i]->Clone()));
+              }
+              m_histograms[i]->Reset();
+            }
+          },
+          [&](Totals& totals) {
+            if (!totals.histograms.empty()) {
+              write(runFileName(file, run), totals, caller);
+            }
+          });
+    }
+
+  private:
+    /// Write the totals of all instances
+    static void write(const std::string& name, const Totals& totals, const std::string& caller) {
+      TFile out(name.c_str(), "RECREATE");
+      if (out.IsZombie()) {
+        dd4hep::printout(dd4hep::ERROR, caller, "Cannot open summary file %s", name.c_str());
+        return;
+      }
+      for (const auto& h : totals.histograms) {
+        out.WriteTObject(h.get());
+      }
+      out.Close();
+      dd4hep::printout(dd4hep::INFO, caller, "Wrote summary histograms to %s", name.c_str());
+    }
+
+    std::vector<std::unique_ptr<TH1D>>   m_histograms;
+    std::shared_ptr<RunSummary<Totals>> m_run;
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_SUMMARYHISTOGRAMS_H
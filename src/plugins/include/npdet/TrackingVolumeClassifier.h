@@ -0,0 +1,80 @@
+#ifndef NPDET_SIM_TRACKINGVOLUMECLASSIFIER_H
+#define NPDET_SIM_TRACKINGVOLUMECLASSIFIER_H
+
+// C/C++ include files
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TGeoShape;
+
+namespace npdet::sim {
+
+  /// Precomputed point-containment classifier for a (tracking) volume shape.
+  /**
+   *  The bounding box of the shape is divided into a regular 3D grid. Each cell
+   *  is classified once, at construction, as fully inside, fully outside or
+   *  crossing the boundary, using TGeoShape::Contains at the cell center and the
+   *  conservative TGeoShape::Safety distance. A query in an inside/outside cell
+   *  is a single table lookup; only boundary cells fall back to the exact TGeo
+   *  shape test. Points outside the bounding box are outside by construction.
+   *
+   *  All coordinates are in DD4hep/ROOT units, in the frame of the shape.
+   *
+   *  The grid is read-only after construction, so one classifier serves all
+   *  threads, see shared().
+   */
+  class TrackingVolumeClassifier {
+  public:
+    /// Classification of one grid cell
+    enum Cell : std::uint8_t { OUTSIDE = 0, INSIDE = 1, BOUNDARY = 2 };
+
+    /// Default constructor: empty classifier, every query uses the exact shape test
+    TrackingVolumeClassifier() = default;
+    /// Build the grid for a shape, using at most max_cells cells
+    TrackingVolumeClassifier(const TGeoShape* shape, std::size_t max_cells);
+
+    /// Classifier for this shape and cell limit, shared by all callers that hold it
+    static std::shared_ptr<const TrackingVolumeClassifier> shared(const TGeoShape* shape, std::size_t max_cells);
+
+    /// True if the point is inside the shape
+    bool contains(const double* point) const {
+      if (m_cells.empty()) {
+        return containsExact(point);
+      }
+      const double fx = (point[0] - m_lo[0]) * m_invStep[0];
+      const double fy = (point[1] - m_lo[1]) * m_invStep[1];
+      const double fz = (point[2] - m_lo[2]) * m_invStep[2];
+      // Negated comparisons also reject NaN coordinates
+      if (!(fx >= 0. && fx < m_n[0] && fy >= 0. && fy < m_n[1] && fz >= 0. && fz < m_n[2])) {
+        return false;
+      }
+      const std::size_t idx = (static_cast<std::size_t>(fz) * m_n[1] + static_cast<std::size_t>(fy)) * m_n[0]
+                            + static_cast<std::size_t>(fx);
+      const auto cell = m_cells[idx];
+      return cell == BOUNDARY ? containsExact(point) : cell == INSIDE;
+    }
+
+    /// Exact TGeo shape test
+    bool containsExact(const double* point) const;
+
+    /// Number of grid cells
+    std::size_t size() const { return m_cells.size(); }
+    /// Fraction of grid cells that require the exact shape test
+    double boundaryFraction() const;
+    /// Grid cell size along each axis
+    std::array<double, 3> cellSize() const;
+
+  private:
+    const TGeoShape*          m_shape{nullptr};
+    std::array<double, 3>     m_lo{};       ///< Lower corner of the bounding box
+    std::array<double, 3>     m_invStep{};  ///< Inverse cell size along each axis
+    std::array<int, 3>        m_n{};        ///< Number of cells along each axis
+    std::vector<std::uint8_t> m_cells;      ///< Cell classification, x fastest
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_TRACKINGVOLUMECLASSIFIER_H
@@ -0,0 +1,71 @@
+#ifndef NPDET_SIM_VERTEXDISTRIBUTION_H
+#define NPDET_SIM_VERTEXDISTRIBUTION_H
+
+// C/C++ include files
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace npdet::sim {
+
+  /// Binned (x, y, z, t) vertex distribution with O(1) sampling.
+  /**
+   *  File format (little endian):
+   *
+   *      char     magic[8]     "NPVTX4D" and a terminating 0
+   *      uint32   version      1
+   *      uint32   nbins[4]     bins in x, y, z, t
+   *      uint32   reserved     0, aligns the doubles that follow
+   *      double   lo[4]        lower edges in x, y, z [mm] and t [ns]
+   *      double   hi[4]        upper edges
+   *      double   weight[nx*ny*nz*nt]
+   *                            index ((ix * ny + iy) * nz + iz) * nt + it
+   *
+   *  The file is memory-mapped while the alias table (Vose's method) is
+   *  built and unmapped afterwards; only the alias table, 8 bytes per bin,
+   *  stays in memory. A sample costs one table lookup and six uniform
+   *  numbers: two for the bin, four for the position inside it.
+   *
+   *  Tables are immutable after construction, so one instance can be shared
+   *  by all worker threads; see shared().
+   */
+  class VertexDistribution {
+  public:
+    /// Load and build from a file; throws std::runtime_error on any format error
+    explicit VertexDistribution(const std::string& path);
+
+    /// Table for this file, shared by all callers that hold it
+    /**
+     *  The first caller loads the file under a mutex; later callers for the
+     *  same path get the same instance as long as one of them still holds it.
+     */
+    static std::shared_ptr<const VertexDistribution> shared(const std::string& path);
+
+    /// Vertex for six uniform random numbers in [0, 1): bin selection and position in the bin
+    std::array<double, 4> sample(double u_bin, double u_alias, double ux, double uy, double uz, double ut) const {
+      auto bin = static_cast<std::size_t>(u_bin * m_probability.size());
+      if (bin >= m_probability.size()) bin = m_probability.size() - 1;
+      if (u_alias >= m_probability[bin]) bin = m_alias[bin];
+      const std::size_t it = bin % m_bins[3];
+      const std::size_t iz = (bin / m_bins[3]) % m_bins[2];
+      const std::size_t iy = (bin / (m_bins[3] * m_bins[2])) % m_bins[1];
+      const std::size_t ix = bin / (m_bins[3] * m_bins[2] * m_bins[1]);
+      return {m_lo[0] + (ix + ux) * m_width[0], m_lo[1] + (iy + uy) * m_width[1],
+              m_lo[2] + (iz + uz) * m_width[2], m_lo[3] + (it + ut) * m_width[3]};
+    }
+
+    /// Number of bins
+    std::size_t size() const { return m_probability.size(); }
+
+  private:
+    std::array<std::size_t, 4> m_bins{};
+    std::array<double, 4>      m_lo{}, m_width{};
+    std::vector<float>         m_probability;
+    std::vector<std::uint32_t> m_alias;
+  };
+
+} // namespace npdet::sim
+
+#endif // NPDET_SIM_VERTEXDISTRIBUTION_H
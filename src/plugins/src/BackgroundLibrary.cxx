@@ -0,0 +1,112 @@
+#include "npdet/BackgroundLibrary.h"
+
+// Framework include files
+#include "DD4hep/Printout.h"
+#include "npdet/HEPMC3PrefetchReader.h"
+#include "npdet/HepMC3EventIndex.h"
+
+// C/C++ include files
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+// POSIX include files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+/// Map and index the file, using the first max_events events (0: all); throws std::runtime_error on errors
+BackgroundLibrary::BackgroundLibrary(const std::string& file, std::size_t max_events) : m_file(file) {
+  const int fd = ::open(file.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size == 0) {
+    const std::string reason = std::strerror(errno);
+    if (fd >= 0) ::close(fd);
+    throw std::runtime_error("Cannot open background input " + file + ": " + reason);
+  }
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Cannot map background input " + file + ": " + std::strerror(errno));
+  }
+  // Events are drawn at random
+  ::madvise(data, st.st_size, MADV_RANDOM);
+  m_data = static_cast<const char*>(data);
+  m_size = st.st_size;
+
+  if (std::string_view(m_data, m_size).substr(0, 7) != "HepMC::") {
+    ::munmap(data, m_size);
+    throw std::runtime_error("Background input " + file + " is not a HepMC3 ASCII file");
+  }
+  HepMC3EventIndex index;
+  if (!HepMC3EventIndex::load(file, index) || index.file_size != m_size) {
+    printout(dd4hep::INFO, "BackgroundLibrary", "+++ No current index %s, scanning %s for events",
+             HepMC3EventIndex::path(file).c_str(), file.c_str());
+    index = HepMC3EventIndex::build(m_data, m_size);
+  }
+  m_offsets = std::move(index.offsets);
+  if (max_events > 0 && m_offsets.size() > max_events) {
+    m_offsets.resize(max_events + 1);
+  } else {
+    m_offsets.push_back(m_size);
+  }
+  if (m_offsets.size() < 2) {
+    ::munmap(data, m_size);
+    throw std::runtime_error("No events in background input " + file);
+  }
+  printout(dd4hep::INFO, "BackgroundLibrary", "+++ %zu background events from %s", size(), file.c_str());
+}
+
+BackgroundLibrary::~BackgroundLibrary() {
+  ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+/// Library for this file, shared by all callers that hold it
+std::shared_ptr<const BackgroundLibrary> BackgroundLibrary::shared(const std::string& file, std::size_t max_events) {
+  static std::mutex                                                     s_lock;
+  static std::map<std::string, std::weak_ptr<const BackgroundLibrary>> s_cache;
+  const std::string key = file + '#' + std::to_string(max_events);
+
+  std::lock_guard<std::mutex> guard(s_lock);
+  auto& cached = s_cache[key];
+  if (auto library = cached.lock()) {
+    return library;
+  }
+  auto library = std::make_shared<const BackgroundLibrary>(file, max_events);
+  cached       = library;
+  return library;
+}
+
+/// New interaction with the event, all particles and vertices tagged with mask; throws std::runtime_error
+Geant4PrimaryInteraction* BackgroundLibrary::interaction(std::size_t event, int mask) const {
+  const std::string_view record(m_data + m_offsets.at(event), m_offsets.at(event + 1) - m_offsets[event]);
+  HEPMC3PrefetchReader::Vertices  vertices;
+  HEPMC3PrefetchReader::Particles particles;
+  const std::string error = HEPMC3PrefetchReader::convert(record, vertices, particles);
+  if (!error.empty()) {
+    for (auto* p : particles) delete p;
+    for (auto* v : vertices) delete v;
+    throw std::runtime_error("Event " + std::to_string(event) + " of " + m_file + ": " + error);
+  }
+  auto* inter = new Geant4PrimaryInteraction();
+  inter->mask = mask;
+  for (Geant4Vertex* v : vertices) {
+    v->mask = mask;
+  }
+  inter->vertices[mask] = std::move(vertices);
+  for (Geant4Particle* p : particles) {
+    p->mask = mask;
+    inter->particles.emplace(p->id, p);
+  }
+  return inter;
+}
+
+} // namespace npdet::sim
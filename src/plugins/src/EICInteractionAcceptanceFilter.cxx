@@ -0,0 +1,136 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/DD4hepUnits.h"
+#include "DD4hep/Printout.h"
+#include "DD4hep/InstanceCount.h"
+#include "DDG4/Geant4Context.h"
+#include "DDG4/Geant4InputHandling.h"
+#include "DDG4/Geant4Particle.h"
+#include "npdet/EICInteractionAcceptanceFilter.h"
+
+// Geant4 include files
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4Run.hh"
+
+// C/C++ include files
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+/// Standard constructor
+EICInteractionAcceptanceFilter::EICInteractionAcceptanceFilter(Geant4Context* ctxt, const std::string& nam)
+  : Geant4GeneratorAction(ctxt, nam)
+{
+  dd4hep::InstanceCount::increment(this);
+  const double inf = std::numeric_limits<double>::infinity();
+  declareProperty("EtaMin",       m_etaMin = -inf);
+  declareProperty("EtaMax",       m_etaMax = inf);
+  declareProperty("PMin",         m_pMin = 0.0);
+  declareProperty("PMax",         m_pMax = inf);
+  declareProperty("PtMin",        m_ptMin = 0.0);
+  declareProperty("PtMax",        m_ptMax = inf);
+  declareProperty("PDG",          m_pdg);
+  declareProperty("MinParticles", m_minParticles = 1);
+  declareProperty("Mask",         m_mask = -1);
+  m_counts = RunSummary<Counts>::attach(this, &EICInteractionAcceptanceFilter::endRun);
+  m_needsControl = true;
+}
+
+/// Default destructor
+EICInteractionAcceptanceFilter::~EICInteractionAcceptanceFilter() {
+  m_counts->detach();
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// End-of-run callback: the last instance to finish the run prints the pass rate of all instances
+void EICInteractionAcceptanceFilter::endRun(const G4Run* run) {
+  m_counts->endOfRun([](Counts&) {}, [this, run](Counts& counts) {
+    const std::size_t events = counts.events.load(), passed = counts.passed.load();
+    if (events > 0) {
+      info("+++ Run %d: %zu of %zu events passed, pass rate %.4f", run->GetRunID(), passed, events,
+           double(passed) / double(events));
+    }
+  });
+}
+
+/// Number of accepted final-state particles of the interaction
+int EICInteractionAcceptanceFilter::accepted(const Interaction* inter) const {
+  // Primary record momenta are in Geant4 units, the cuts in DD4hep units
+  const double toDD4hep = dd4hep::GeV / CLHEP::GeV;
+  int count = 0;
+  for (const auto& [id, p] : inter->particles) {
+    int bits = p->status;
+    if (!PropertyMask(bits).isSet(G4PARTICLE_GEN_STABLE)) continue;
+    if (!m_pdg.empty() && std::find(m_pdg.begin(), m_pdg.end(), p->pdgID) == m_pdg.end()) continue;
+    const double pt = std::hypot(p->psx, p->psy) * toDD4hep;
+    const double pp = std::hypot(pt, p->psz * toDD4hep);
+    if (pt < m_ptMin || pt > m_ptMax || pp < m_pMin || pp > m_pMax) continue;
+    // Along the beam axis eta is +-infinity, which the default range accepts
+    const double eta = pt > 0 ? std::asinh(p->psz * toDD4hep / pt) : std::copysign(HUGE_VAL, p->psz);
+    if (eta < m_etaMin || eta > m_etaMax) continue;
+    ++count;
+  }
+  return count;
+}
+
+/// Remove all particles and vertices of the interaction
+void EICInteractionAcceptanceFilter::clear(Interaction* inter) {
+  for (auto& [id, p] : inter->particles) {
+    if (p) p->release();
+  }
+  inter->particles.clear();
+  for (auto& [mask, vertices] : inter->vertices) {
+    for (Geant4Vertex* v : vertices) {
+      if (v) v->release();
+    }
+  }
+  inter->vertices.clear();
+}
+
+/// Callback to generate primary particles
+void EICInteractionAcceptanceFilter::operator()(G4Event*) {
+  Geant4PrimaryEvent* evt = context()->event().extension<Geant4PrimaryEvent>();
+  std::vector<Interaction*> interactions;
+  if (m_mask >= 0) {
+    if (Interaction* inter = evt->get(m_mask)) {
+      interactions.push_back(inter);
+    } else {
+      print("+++ No interaction of mask/type %d present.", m_mask);
+    }
+  } else {
+    interactions = evt->interactions();
+  }
+
+  Counts& counts = m_counts->totals();
+  counts.events.fetch_add(1, std::memory_order_relaxed);
+  int count = 0;
+  for (const Interaction* inter : interactions) {
+    if (inter->locked) {
+      this->abortRun("Locked interactions may not be filtered!",
+                     "Cannot filter interactions with a native G4 primary record!");
+      return;
+    }
+    count += accepted(inter);
+  }
+  if (count >= m_minParticles) {
+    counts.passed.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  debug("+++ Event rejected: %d accepted particles, %d required", count, m_minParticles);
+  for (Interaction* inter : interactions) {
+    clear(inter);
+  }
+}
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+using EICInteractionAcceptanceFilter = npdet::sim::EICInteractionAcceptanceFilter;
+}
+
+DECLARE_GEANT4ACTION(EICInteractionAcceptanceFilter)
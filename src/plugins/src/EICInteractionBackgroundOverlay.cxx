@@ -0,0 +1,157 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/DD4hepUnits.h"
+#include "DD4hep/Printout.h"
+#include "DD4hep/InstanceCount.h"
+#include "DDG4/Geant4Random.h"
+#include "DDG4/Geant4Context.h"
+#include "DDG4/Geant4InputHandling.h"
+#include "DDG4/Geant4Kernel.h"
+#include "npdet/EICInteractionBackgroundOverlay.h"
+#include "npdet/LorentzTransform.h"
+
+// Geant4 include files
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4Run.hh"
+
+// C/C++ include files
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+namespace {
+
+  /// Source numbers and first masks of the overlay actions, by action name
+  struct MaskRegistry {
+    std::mutex                 lock;
+    std::map<std::string, int> sources;
+    std::map<std::string, int> masks;
+  };
+
+  MaskRegistry& maskRegistry() {
+    static MaskRegistry registry;
+    return registry;
+  }
+
+} // namespace
+
+/// Standard constructor
+EICInteractionBackgroundOverlay::EICInteractionBackgroundOverlay(Geant4Context* ctxt, const std::string& nam)
+  : Geant4GeneratorAction(ctxt, nam)
+{
+  dd4hep::InstanceCount::increment(this);
+  declareProperty("Input",        m_input);
+  declareProperty("MaxEvents",    m_maxEvents = 0);
+  declareProperty("Mean",         m_mean = 1.0);
+  declareProperty("BunchSpacing", m_bunchSpacing = 10.15 * dd4hep::ns);
+  declareProperty("CrossingMin",  m_crossingMin = 0);
+  declareProperty("CrossingMax",  m_crossingMax = 0);
+  declareProperty("Mask",         m_mask = -1);
+  {
+    MaskRegistry&               registry = maskRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    m_source = registry.sources.emplace(name(), int(registry.sources.size())).first->second;
+  }
+  context()->kernel().runAction().callAtBegin(this, &EICInteractionBackgroundOverlay::beginRun);
+  m_counts = RunSummary<Counts>::attach(this, &EICInteractionBackgroundOverlay::endRun);
+  m_needsControl = true;
+}
+
+/// Default destructor
+EICInteractionBackgroundOverlay::~EICInteractionBackgroundOverlay() {
+  m_counts->detach();
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// Begin-of-run callback: assign the masks and open the input
+///
+/// Properties are set after the action is constructed, so the masks are
+/// checked here rather than in the constructor.
+void EICInteractionBackgroundOverlay::beginRun(const G4Run*) {
+  if (m_input.empty()) {
+    except("+++ No background input given (property Input).");
+  }
+  if (m_crossingMax < m_crossingMin) {
+    except("+++ CrossingMax %d is below CrossingMin %d.", m_crossingMax, m_crossingMin);
+  }
+  m_firstMask = m_mask >= 0 ? m_mask : s_maskBase + m_source * s_maskStride;
+  {
+    MaskRegistry&               registry = maskRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    for (const auto& [source, mask] : registry.masks) {
+      if (source != name() && std::abs(mask - m_firstMask) < s_maskStride) {
+        except("+++ Masks [%d, %d) overlap the masks [%d, %d) of %s; set Mask %d apart.", m_firstMask,
+               m_firstMask + s_maskStride, mask, mask + s_maskStride, source.c_str(), s_maskStride);
+      }
+    }
+    registry.masks[name()] = m_firstMask;
+  }
+  try {
+    m_library = BackgroundLibrary::shared(m_input, std::max(m_maxEvents, 0));
+  } catch (const std::exception& e) {
+    except("+++ %s", e.what());
+  }
+  debug("+++ Background interactions with masks [%d, %d)", m_firstMask, m_firstMask + s_maskStride);
+}
+
+/// End-of-run callback: the last instance to finish the run prints the numbers of all instances
+void EICInteractionBackgroundOverlay::endRun(const G4Run* run) {
+  m_counts->endOfRun([](Counts&) {}, [this, run](Counts& counts) {
+    const std::size_t events = counts.events.load(), overlaid = counts.overlaid.load();
+    if (events > 0) {
+      info("+++ Run %d: %zu background interactions in %zu events, %.3f per event", run->GetRunID(), overlaid,
+           events, double(overlaid) / double(events));
+    }
+  });
+}
+
+/// Callback to generate primary particles
+void EICInteractionBackgroundOverlay::operator()(G4Event*) {
+  Geant4PrimaryEvent* evt    = context()->event().extension<Geant4PrimaryEvent>();
+  Geant4Random&       rndm   = context()->event().random();
+  Counts&             counts = m_counts->totals();
+  int n = static_cast<int>(rndm.poisson(m_mean));
+  counts.events.fetch_add(1, std::memory_order_relaxed);
+  if (n > s_maskStride) {
+    warning("+++ %d background interactions drawn, only %d added.", n, s_maskStride);
+    n = s_maskStride;
+  }
+  for (int i = 0; i < n; ++i) {
+    const int mask = m_firstMask + i;
+    if (evt->get(mask)) {
+      error("+++ Interaction with mask %d exists already; %d background interactions not added.", mask, n - i);
+      break;
+    }
+    const auto event    = std::min(static_cast<std::size_t>(rndm.uniform(0, m_library->size())), m_library->size() - 1);
+    const int  crossing = std::min(m_crossingMin + static_cast<int>(rndm.uniform(0, m_crossingMax - m_crossingMin + 1)),
+                                   m_crossingMax);
+    // Bunch spacing in DD4hep units, primary record times in ns
+    const double time = crossing * m_bunchSpacing / dd4hep::ns * CLHEP::ns;
+
+    Interaction* inter = nullptr;
+    try {
+      inter = m_library->interaction(event, mask);
+    } catch (const std::exception& e) {
+      except("+++ %s", e.what());
+    }
+    translateInteraction(inter, ROOT::Math::XYZTVector(0, 0, 0, time));
+    evt->add(mask, inter);
+    counts.overlaid.fetch_add(1, std::memory_order_relaxed);
+    debug("+++ Background event %zu as interaction %d at crossing %+d (%+.2f ns)", event, mask, crossing, time);
+  }
+}
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+using EICInteractionBackgroundOverlay = npdet::sim::EICInteractionBackgroundOverlay;
+}
+
+DECLARE_GEANT4ACTION(EICInteractionBackgroundOverlay)
@@ -0,0 +1,151 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/DD4hepUnits.h"
+#include "DD4hep/Printout.h"
+#include "DD4hep/InstanceCount.h"
+#include "DDG4/Geant4Random.h"
+#include "DDG4/Geant4Context.h"
+#include "DDG4/Geant4InputHandling.h"
+#include "npdet/EICInteractionVertexBeamEffects.h"
+#include "npdet/LorentzTransform.h"
+
+// Geant4 include files
+#include "CLHEP/Units/PhysicalConstants.h"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4Run.hh"
+
+// C/C++ include files
+#include <cmath>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+namespace {
+  /// Maximum number of hourglass trials per vertex
+  constexpr std::size_t s_maxTrials = 1000;
+}
+
+/// Standard constructor
+EICInteractionVertexBeamEffects::EICInteractionVertexBeamEffects(Geant4Context* ctxt, const std::string& nam)
+  : Geant4GeneratorAction(ctxt, nam)
+{
+  dd4hep::InstanceCount::increment(this);
+  declareProperty("IonBunchLength",        m_ionBunchLength = 6.0 * dd4hep::cm);
+  declareProperty("ElectronBunchLength",   m_eBunchLength = 0.9 * dd4hep::cm);
+  declareProperty("IonBetaStarX",          m_ionBetaStarX = 80.0 * dd4hep::cm);
+  declareProperty("IonBetaStarY",          m_ionBetaStarY = 7.2 * dd4hep::cm);
+  declareProperty("ElectronBetaStarX",     m_eBetaStarX = 55.0 * dd4hep::cm);
+  declareProperty("ElectronBetaStarY",     m_eBetaStarY = 5.6 * dd4hep::cm);
+  declareProperty("IonEmittanceX",         m_ionEmittanceX = 11.3 * dd4hep::nm);
+  declareProperty("IonEmittanceY",         m_ionEmittanceY = 1.0 * dd4hep::nm);
+  declareProperty("ElectronEmittanceX",    m_eEmittanceX = 20.0 * dd4hep::nm);
+  declareProperty("ElectronEmittanceY",    m_eEmittanceY = 1.3 * dd4hep::nm);
+  declareProperty("IonCrossingAngle",      m_ionCrossingAngle = 0.0166667);
+  declareProperty("ElectronCrossingAngle", m_eCrossingAngle = 0.00833333);
+  declareProperty("CrabCrossing",          m_crabCrossing = true);
+  declareProperty("Hourglass",             m_hourglass = true);
+  declareProperty("Offset",                m_offset);
+  declareProperty("Mask",                  m_mask = -1);
+  m_counts = RunSummary<Counts>::attach(this, &EICInteractionVertexBeamEffects::endRun);
+  m_needsControl = true;
+}
+
+/// Default destructor
+EICInteractionVertexBeamEffects::~EICInteractionVertexBeamEffects() {
+  m_counts->detach();
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// End-of-run callback: the last instance to finish the run prints the acceptance of all instances
+void EICInteractionVertexBeamEffects::endRun(const G4Run* run) {
+  m_counts->endOfRun([](Counts&) {}, [this, run](Counts& counts) {
+    const std::size_t interactions = counts.interactions.load(), trials = counts.trials.load();
+    if (interactions > 0) {
+      info("+++ Run %d: %zu interactions in %zu trials, hourglass acceptance %.3f", run->GetRunID(), interactions,
+           trials, double(interactions) / double(trials));
+    }
+  });
+}
+
+/// Draw the vertex (x, y, z, t) of one interaction, in Geant4 units
+ROOT::Math::XYZTVector EICInteractionVertexBeamEffects::sampleVertex() {
+  Geant4Random& rndm = context()->event().random();
+  // Beam size squared at distance z from the focus
+  auto size2 = [](double emittance, double beta, double z) {
+    return emittance * beta * (1.0 + (z / beta) * (z / beta));
+  };
+
+  const double sx0 = size2(m_ionEmittanceX, m_ionBetaStarX, 0) + size2(m_eEmittanceX, m_eBetaStarX, 0);
+  const double sy0 = size2(m_ionEmittanceY, m_ionBetaStarY, 0) + size2(m_eEmittanceY, m_eBetaStarY, 0);
+  double zh = 0, ze = 0, z = 0;
+  double sxh = 0, sxe = 0, syh = 0, sye = 0;
+  std::size_t trials = 0;
+  while (trials < s_maxTrials) {
+    ++trials;
+    zh  = rndm.gauss(0, m_ionBunchLength);
+    ze  = rndm.gauss(0, m_eBunchLength);
+    z   = 0.5 * (zh + ze);
+    sxh = size2(m_ionEmittanceX, m_ionBetaStarX, z);
+    sxe = size2(m_eEmittanceX, m_eBetaStarX, z);
+    syh = size2(m_ionEmittanceY, m_ionBetaStarY, z);
+    sye = size2(m_eEmittanceY, m_eBetaStarY, z);
+    // Luminosity weight relative to its maximum at the focus
+    if (!m_hourglass || rndm.uniform() < std::sqrt(sx0 * sy0 / ((sxh + sxe) * (syh + sye)))) {
+      break;
+    }
+  }
+  m_counts->totals().trials.fetch_add(trials, std::memory_order_relaxed);
+
+  // Overlap of the two transverse Gaussians
+  double x = rndm.gauss(0, std::sqrt(sxh * sxe / (sxh + sxe)));
+  double y = rndm.gauss(0, std::sqrt(syh * sye / (syh + sye)));
+  const double alpha = m_ionCrossingAngle + m_eCrossingAngle;
+  if (m_crabCrossing) {
+    x += std::tan(alpha / 2.0) * 0.5 * (ze - zh);
+  }
+
+  // Into the detector frame, as EICInteractionVertexBoost
+  const double a  = alpha / 2.0 - m_eCrossingAngle;
+  const double xr = std::cos(a) * x + std::sin(a) * z;
+  const double zr = -std::sin(a) * x + std::cos(a) * z;
+
+  const double toG4 = CLHEP::mm / dd4hep::mm;
+  const double t    = (ze - zh) * toG4 / (2.0 * CLHEP::c_light);
+  return {(xr + m_offset.x()) * toG4, (y + m_offset.y()) * toG4, (zr + m_offset.z()) * toG4, t + m_offset.t()};
+}
+
+/// Callback to generate primary particles
+void EICInteractionVertexBeamEffects::operator()(G4Event*) {
+  Geant4PrimaryEvent* evt = context()->event().extension<Geant4PrimaryEvent>();
+  std::vector<Interaction*> interactions;
+  if (m_mask >= 0) {
+    if (Interaction* inter = evt->get(m_mask)) {
+      interactions.push_back(inter);
+    } else {
+      print("+++ No interaction of mask/type %d present.", m_mask);
+    }
+  } else {
+    interactions = evt->interactions();
+  }
+  for (Interaction* inter : interactions) {
+    if (inter->locked) {
+      this->abortRun("Locked interactions may not be smeared!",
+                     "Cannot smear interactions with a native G4 primary record!");
+      return;
+    }
+    m_counts->totals().interactions.fetch_add(1, std::memory_order_relaxed);
+    const auto vertex = sampleVertex();
+    debug("+++ Vertex (%+.3f mm, %+.3f mm, %+.3f mm, %+.4f ns)", vertex.x(), vertex.y(), vertex.z(), vertex.t());
+    translateInteraction(inter, vertex);
+  }
+}
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+using EICInteractionVertexBeamEffects = npdet::sim::EICInteractionVertexBeamEffects;
+}
+
+DECLARE_GEANT4ACTION(EICInteractionVertexBeamEffects)
@@ -6,12 +6,11 @@
 #include "DDG4/Geant4InputHandling.h"
 #include "npdet/EICInteractionVertexBoost.h"
 
+#include "G4Run.hh"
+
+#include "Math/Vector3D.h"
 #include "Math/Vector4D.h"
 #include "Math/LorentzRotation.h"
-#include "Math/Boost.h"
-#include "Math/BoostX.h"
-#include "Math/BoostX.h"
-#include "Math/PxPyPzM4D.h"
 
 
 namespace npdet::sim {
@@ -27,89 +26,81 @@ EICInteractionVertexBoost::EICInteractionVertexBoost(Geant4Context* ctxt, const
   declareProperty("IonCrossingAngle", m_ionCrossingAngle = 0.0166667);
   declareProperty("ElectronCrossingAngle", m_eCrossingAngle = 0.00833333);
   declareProperty("Mask",  m_mask = 1);
+  declareProperty("SummaryFile", m_summaryFile);
+  m_summary.attach(this, &EICInteractionVertexBoost::endRun);
   m_needsControl = true;
 }
 
 /// Default destructor
 EICInteractionVertexBoost::~EICInteractionVertexBoost() {
+  m_summary.detach();
   dd4hep::InstanceCount::decrement(this);
 }
 
+/// End-of-run callback: write the summary histograms of all instances
+void EICInteractionVertexBoost::endRun(const G4Run* run) {
+  m_summary.endOfRun(m_summaryFile, run->GetRunID(), name());
+}
+
+/// Recompute the crossing-angle transformation if the angle properties changed
+void EICInteractionVertexBoost::updateTransform() {
+  if (m_transformValid && m_ionCrossingAngle == m_cachedIonCrossingAngle &&
+      m_eCrossingAngle == m_cachedECrossingAngle) {
+    return;
+  }
+  m_cachedIonCrossingAngle = m_ionCrossingAngle;
+  m_cachedECrossingAngle   = m_eCrossingAngle;
+  m_transformValid         = true;
+
+  const double alpha = m_ionCrossingAngle+m_eCrossingAngle;
+  m_transform = LorentzTransform(crossingAngleBoost(m_ionCrossingAngle, m_eCrossingAngle));
+  debug("+++ Boost: beta = %f, gamma = %f, alpha = %f deg",
+        std::sin(alpha/2.0), 1.0/std::cos(alpha/2.0), alpha*180.0/M_PI);
+}
+
 /// Action to boost one single interaction according to the properties
-void EICInteractionVertexBoost::boost(Interaction* inter)  const  {
+void EICInteractionVertexBoost::boost(Interaction* inter) {
   using namespace ROOT::Math;
-      //    boostInteraction(this, inter, m_angle);
-      // int dd4hep::sim::boostInteraction(const Geant4Action* caller,
-      //                                  Geant4PrimaryEvent::Interaction* inter,
-      //                                  double alpha)
   if (inter) {
-    Geant4PrimaryEvent::Interaction::VertexMap::iterator   iv;
-    Geant4PrimaryEvent::Interaction::ParticleMap::iterator ip;
-
     double alpha = m_ionCrossingAngle+m_eCrossingAngle;
 
     if (inter->locked) {
       this->abortRun("Locked interactions may not be boosted!",
                        "Cannot boost interactions with a native G4 primary record!");
     } else if (alpha != 0.0) {
+      updateTransform();
 
-      double tanalpha  = std::tan(alpha/2.0);
-      double gamma     = std::sqrt(1 + tanalpha * tanalpha);
-      double betagamma = tanalpha;
-      double beta      = betagamma / gamma;
-
-      std::cout << " beta   = " << beta  << "\n";
-      std::cout << " gamma  = " << gamma << "\n";
-      std::cout << " alpha  = " << alpha*180.0/M_PI << " deg\n";
-
-      BoostX           bst(beta);
-      LorentzRotation roty(RotationY(alpha/2.0-m_eCrossingAngle));
-
-      // Now move begin and end-vertex of all primary vertices accordingly
-      for (iv = inter->vertices.begin(); iv != inter->vertices.end(); ++iv) {
-        for (Geant4Vertex* v : (*iv).second) {
-          XYZTVector v0(v->x,v->y,v->z,v->time);
-          auto v1 = roty(bst*v0);
-          //double t = gamma * v->time + betagamma * v->x / CLHEP::c_light;
-          //double x = gamma * v->x + betagamma * CLHEP::c_light * v->time;
-          //double y = v->y;
-          //double z = v->z;
-          v->x     = v1.x();
-          v->y     = v1.y();
-          v->z     = v1.z();
-          v->time  = v1.t();
+      if (!m_summaryFile.empty() && m_summary.empty()) {
+        m_hDeltaTheta = m_summary.book("dtheta", "Change of particle polar angle;#Delta#theta [rad]",
+                                       200, -2.0 * std::abs(alpha), 2.0 * std::abs(alpha));
+      }
+      const bool summary = !m_summary.empty();
+      const bool verbose = outputLevel() <= dd4hep::VERBOSE;
+      // Polar angles before the boost, only needed for the summary
+      std::vector<double> theta0;
+      if (summary) {
+        theta0.reserve(inter->particles.size());
+        for (const auto& [id, p] : inter->particles) {
+          theta0.push_back(XYZVector(p->psx, p->psy, p->psz).Theta());
         }
       }
-      // Now move begin and end-vertex of all primary and generator particles accordingly
-      for (ip = inter->particles.begin(); ip != inter->particles.end(); ++ip) {
-        Geant4ParticleHandle p = (*ip).second;
-        //double               t = gamma * p->time + betagamma * p->vsx / CLHEP::c_light;
-        //double               x = gamma * p->vsx + betagamma * CLHEP::c_light * p->time;
-        //double               y = p->vsy;
-        //double               z = p->vsz;
-
-        XYZTVector v0{p->vsx,p->vsy,p->vsz,p->time};
-        auto v1 = roty(bst*v0);
-
-        PxPyPzMVector p0{p->psx,p->psy,p->psz,p->mass};
-        auto p1 = roty(bst*p0);
-        //double m  = p->mass;
-        //double e2 = SQR(p->psx) + SQR(p->psy) + SQR(p->psz) + SQR(m);
-        //double px = betagamma * std::sqrt(e2) + gamma * p->psx;
-        //double py = p->psy;
-        //double pz = p->psz;
-
-        p->vsx  = v1.x();
-        p->vsy  = v1.y();
-        p->vsz  = v1.z();
-        p->time = v1.t();
-
-        p->psx = p1.x();
-        p->psy = p1.y();
-        p->psz = p1.z();
-
-        std::cout << p1 << "\n";
-        std::cout << " theta = " << p1.Theta() << " \n";
+
+      // Move all primary vertices, and the start vertex and momentum of all
+      // primary and generator particles, with one matrix product per four-vector
+      transformInteraction(inter, m_transform, XYZTVector(), m_batch);
+
+      if (summary || verbose) {
+        std::size_t i = 0;
+        for (const auto& [id, p] : inter->particles) {
+          const double theta = XYZVector(p->psx, p->psy, p->psz).Theta();
+          if (summary) {
+            m_summary.fill(m_hDeltaTheta, theta - theta0[i++]);
+          }
+          if (verbose) {
+            printout(dd4hep::VERBOSE, name(), "+++ Boosted particle %d: p = (%f, %f, %f), theta = %f",
+                     p->id, p->psx, p->psy, p->psz, theta);
+          }
+        }
       }
     }
   }
@@ -124,7 +115,6 @@ void EICInteractionVertexBoost::operator()(G4Event*) {
   Geant4PrimaryEvent* evt = context()->event().extension<Geant4PrimaryEvent>();
 
   if ( m_mask >= 0 )  {
-    std::cout << " mask is not zero\n";
     Interaction* inter = evt->get(m_mask);
     boost(inter);
     return;
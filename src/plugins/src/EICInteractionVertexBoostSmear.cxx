@@ -0,0 +1,106 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/Printout.h"
+#include "DD4hep/InstanceCount.h"
+#include "DDG4/Geant4Random.h"
+#include "DDG4/Geant4Context.h"
+#include "DDG4/Geant4InputHandling.h"
+#include "npdet/EICInteractionVertexBoostSmear.h"
+#include "npdet/LorentzTransform.h"
+
+// C/C++ include files
+#include <cmath>
+
+#include "Math/AxisAngle.h"
+#include "Math/Boost.h"
+#include "Math/RotationX.h"
+#include "Math/RotationY.h"
+#include "Math/Vector3D.h"
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+/// Standard constructor
+EICInteractionVertexBoostSmear::EICInteractionVertexBoostSmear(Geant4Context* ctxt, const std::string& nam)
+  : Geant4GeneratorAction(ctxt, nam)
+{
+  dd4hep::InstanceCount::increment(this);
+  declareProperty("IonCrossingAngle", m_ionCrossingAngle = 0.0166667);
+  declareProperty("ElectronCrossingAngle", m_eCrossingAngle = 0.00833333);
+  declareProperty("Offset", m_offset);
+  declareProperty("Sigma_ion", m_sigma_Ion);
+  declareProperty("VertexOffset", m_vertexOffset);
+  declareProperty("Mask", m_mask = -1);
+  m_needsControl = true;
+}
+
+/// Default destructor
+EICInteractionVertexBoostSmear::~EICInteractionVertexBoostSmear() {
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// Crossing-angle boost, recomputed only when the angles changed
+const ROOT::Math::LorentzRotation& EICInteractionVertexBoostSmear::crossing() {
+  if (m_ionCrossingAngle != m_cachedIonCrossingAngle || m_eCrossingAngle != m_cachedECrossingAngle) {
+    m_cachedIonCrossingAngle = m_ionCrossingAngle;
+    m_cachedECrossingAngle   = m_eCrossingAngle;
+    m_crossing = crossingAngleBoost(m_ionCrossingAngle, m_eCrossingAngle);
+    debug("+++ Crossing-angle boost: alpha = %f mrad", (m_ionCrossingAngle + m_eCrossingAngle) * 1e3);
+  }
+  return m_crossing;
+}
+
+/// Per-event beam-divergence rotation
+ROOT::Math::LorentzRotation EICInteractionVertexBoostSmear::divergence() const {
+  using namespace ROOT::Math;
+  Geant4Random& rndm = context()->event().random();
+  const double  dx   = rndm.gauss(m_offset.x(), m_sigma_Ion.x());
+  const double  dy   = rndm.gauss(m_offset.y(), m_sigma_Ion.y());
+  const XYZVector ion_dir(0, 0, 1.0);
+  const auto      new_ion_dir = RotationY(-dx)(RotationX(dy)(ion_dir));
+  const double    alpha       = new_ion_dir.Theta();
+  if (alpha == 0.0) {
+    return LorentzRotation();
+  }
+  const double tanalpha = std::tan(alpha / 2.0);
+  const double gamma    = std::sqrt(1 + tanalpha * tanalpha);
+  const double beta     = tanalpha / gamma;
+  const Polar3DVector boost_vec(beta, M_PI / 2.0, new_ion_dir.Phi());
+  const auto rotation_axis = ion_dir.Cross(new_ion_dir).Unit();
+  return LorentzRotation(AxisAngle(rotation_axis, alpha / 2.0)) * LorentzRotation(Boost(boost_vec));
+}
+
+/// Callback to generate primary particles
+void EICInteractionVertexBoostSmear::operator()(G4Event*) {
+  Geant4PrimaryEvent* evt = context()->event().extension<Geant4PrimaryEvent>();
+  std::vector<Interaction*> interactions;
+  if (m_mask >= 0) {
+    if (Interaction* inter = evt->get(m_mask)) {
+      interactions.push_back(inter);
+    } else {
+      print("+++ No interaction of mask/type %d present.", m_mask);
+    }
+  } else {
+    interactions = evt->interactions();
+  }
+  for (Interaction* inter : interactions) {
+    if (inter->locked) {
+      this->abortRun("Locked interactions may not be boosted!",
+                     "Cannot boost interactions with a native G4 primary record!");
+      return;
+    }
+    // Smearing first, then the crossing-angle boost, as for Smear followed by Boost
+    const LorentzTransform transform(crossing() * divergence());
+    transformInteraction(inter, transform, m_vertexOffset, m_batch);
+  }
+}
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+using EICInteractionVertexBoostSmear = npdet::sim::EICInteractionVertexBoostSmear;
+}
+
+DECLARE_GEANT4ACTION(EICInteractionVertexBoostSmear)
@@ -0,0 +1,97 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/DD4hepUnits.h"
+#include "DD4hep/Printout.h"
+#include "DD4hep/InstanceCount.h"
+#include "DDG4/Geant4Random.h"
+#include "DDG4/Geant4Context.h"
+#include "DDG4/Geant4InputHandling.h"
+#include "DDG4/Geant4Kernel.h"
+#include "npdet/EICInteractionVertexDistribution.h"
+#include "npdet/LorentzTransform.h"
+
+// Geant4 include files
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4Run.hh"
+
+// C/C++ include files
+#include <stdexcept>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+/// Standard constructor
+EICInteractionVertexDistribution::EICInteractionVertexDistribution(Geant4Context* ctxt, const std::string& nam)
+  : Geant4GeneratorAction(ctxt, nam)
+{
+  dd4hep::InstanceCount::increment(this);
+  declareProperty("File",   m_file);
+  declareProperty("Offset", m_offset);
+  declareProperty("Mask",   m_mask = -1);
+  context()->kernel().runAction().callAtBegin(this, &EICInteractionVertexDistribution::beginRun);
+  m_needsControl = true;
+}
+
+/// Default destructor
+EICInteractionVertexDistribution::~EICInteractionVertexDistribution() {
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// Begin-of-run callback: load and validate the distribution
+///
+/// Properties are set after the action is constructed, so the file is read
+/// here rather than in the constructor, and a bad file stops the run before
+/// the first event.
+void EICInteractionVertexDistribution::beginRun(const G4Run*) {
+  if (m_file.empty()) {
+    except("+++ No vertex distribution file given (property File).");
+  }
+  try {
+    m_table = VertexDistribution::shared(m_file);
+  } catch (const std::exception& e) {
+    except("+++ %s", e.what());
+  }
+  info("+++ Vertex distribution %s with %zu bins", m_file.c_str(), m_table->size());
+}
+
+/// Callback to generate primary particles
+void EICInteractionVertexDistribution::operator()(G4Event*) {
+  Geant4PrimaryEvent* evt = context()->event().extension<Geant4PrimaryEvent>();
+  std::vector<Interaction*> interactions;
+  if (m_mask >= 0) {
+    if (Interaction* inter = evt->get(m_mask)) {
+      interactions.push_back(inter);
+    } else {
+      print("+++ No interaction of mask/type %d present.", m_mask);
+    }
+  } else {
+    interactions = evt->interactions();
+  }
+
+  Geant4Random& rndm = context()->event().random();
+  const double  toG4 = CLHEP::mm / dd4hep::mm;
+  for (Interaction* inter : interactions) {
+    if (inter->locked) {
+      this->abortRun("Locked interactions may not be smeared!",
+                     "Cannot smear interactions with a native G4 primary record!");
+      return;
+    }
+    const double u_bin = rndm.uniform(), u_alias = rndm.uniform();
+    const double ux = rndm.uniform(), uy = rndm.uniform(), uz = rndm.uniform(), ut = rndm.uniform();
+    const auto   v  = m_table->sample(u_bin, u_alias, ux, uy, uz, ut);
+    const ROOT::Math::XYZTVector vertex(v[0] + m_offset.x() * toG4, v[1] + m_offset.y() * toG4,
+                                        v[2] + m_offset.z() * toG4, v[3] + m_offset.t());
+    debug("+++ Vertex (%+.3f mm, %+.3f mm, %+.3f mm, %+.4f ns)", vertex.x(), vertex.y(), vertex.z(), vertex.t());
+    translateInteraction(inter, vertex);
+  }
+}
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+using EICInteractionVertexDistribution = npdet::sim::EICInteractionVertexDistribution;
+}
+
+DECLARE_GEANT4ACTION(EICInteractionVertexDistribution)
@@ -8,6 +8,8 @@
 #include "DDG4/Geant4InputHandling.h"
 #include "npdet/EICInteractionVertexSmear.h"
 
+#include "G4Run.hh"
+
 // C/C++ include files
 #include <cmath>
 
@@ -36,14 +38,24 @@ EICInteractionVertexSmear::EICInteractionVertexSmear(Geant4Context* ctxt, const
   declareProperty("Sigma_ion",  m_sigma_Ion);
   declareProperty("Sigma_e",  m_sigma_Electron);
   declareProperty("Mask",   m_mask = 0);
+  declareProperty("SummaryFile", m_summaryFile);
+  m_summary.attach(this, &EICInteractionVertexSmear::endRun);
   m_needsControl = true;
 }
 
 /// Default destructor
-EICInteractionVertexSmear::~EICInteractionVertexSmear() { dd4hep::InstanceCount::decrement(this); }
+EICInteractionVertexSmear::~EICInteractionVertexSmear() {
+  m_summary.detach();
+  dd4hep::InstanceCount::decrement(this);
+}
+
+/// End-of-run callback: write the summary histograms of all instances
+void EICInteractionVertexSmear::endRun(const G4Run* run) {
+  m_summary.endOfRun(m_summaryFile, run->GetRunID(), name());
+}
 
 /// Action to smear one single interaction according to the properties
-void EICInteractionVertexSmear::smear(Interaction* inter) const {
+void EICInteractionVertexSmear::smear(Interaction* inter) {
   using namespace ROOT::Math;
   Geant4Random& rndm = context()->event().random();
   if (inter) {
@@ -66,6 +78,19 @@ void EICInteractionVertexSmear::smear(Interaction* inter) const {
     double alpha         = new_ion_dir.Theta();
     auto   rotation_axis = ion_dir.Cross(new_ion_dir).Unit();
 
+    if (!m_summaryFile.empty()) {
+      if (m_summary.empty()) {
+        const double sx = 5.0 * m_sigma_Ion.x(), sy = 5.0 * m_sigma_Ion.y();
+        m_hDx    = m_summary.book("dx", "Divergence angle x;dx [rad]", 100, m_offset.x() - sx, m_offset.x() + sx);
+        m_hDy    = m_summary.book("dy", "Divergence angle y;dy [rad]", 100, m_offset.y() - sy, m_offset.y() + sy);
+        m_hAlpha = m_summary.book("alpha", "Rotation angle;#alpha [rad]", 100, 0.0,
+                                  std::hypot(std::abs(m_offset.x()) + sx, std::abs(m_offset.y()) + sy));
+      }
+      m_summary.fill(m_hDx, dx);
+      m_summary.fill(m_hDy, dy);
+      m_summary.fill(m_hAlpha, alpha);
+    }
+
     if (inter->locked) {
       this->abortRun("Locked interactions may not be boosted!",
                      "Cannot boost interactions with a native G4 primary record!");
@@ -78,7 +103,7 @@ void EICInteractionVertexSmear::smear(Interaction* inter) const {
 
       Polar3D boost_vec(beta, M_PI / 2.0, new_ion_dir.Phi());
 
-      std::cout << " beta = " << beta << "\n";
+      debug("+++ Smear: dx = %g, dy = %g, alpha = %g, beta = %g", dx, dy, alpha, beta);
 
       Boost           bst(boost_vec);
       LorentzRotation roty(AxisAngle(rotation_axis, alpha / 2.0));
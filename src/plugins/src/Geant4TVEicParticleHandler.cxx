@@ -9,13 +9,15 @@
 //  — and then layers an additional EIC-specific cut on top:
 //
 //    Drop low-|p| particles that ended in the far forward or far backward
-//    Z regions, unless they are primaries, KEEP_ALWAYS, or contributed to
-//    a tracker hit. Calorimeter-hit particles are optionally protected via
-//    the KeepCaloHitParticles property.
+//    Z regions, or below the thresholds of a user-defined (r,z) region,
+//    unless they are primaries, KEEP_ALWAYS, or contributed to a tracker
+//    hit. Calorimeter-hit particles are optionally protected via the
+//    KeepCaloHitParticles property.
 //
 //  Configurable properties (in DD4hep units):
 //    ForwardRegionZ, BackwardRegionZ, ForwardMomentumMin,
-//    BackwardMomentumMin, KeepCaloHitParticles.
+//    BackwardMomentumMin, RegionCuts, KeepCaloHitParticles,
+//    FastContainment, Statistics, StatisticsFile, TimeContainment.
 //
 //  See Geant4TVEicParticleHandler.md for the full description.
 //
@@ -33,13 +35,43 @@
 #include <DDG4/Geant4Particle.h>
 #include <DDG4/Geant4UserParticleHandler.h>
 
+#include "npdet/RegionCutTable.h"
+#include "npdet/RunFileName.h"
+#include "npdet/RunSummary.h"
+#include "npdet/TrackingVolumeClassifier.h"
+
 #include <CLHEP/Units/SystemOfUnits.h>
+#include <G4Run.hh>
 
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 
 namespace npdet::sim {
 
+  /// Reason bits reported in the handler statistics
+  constexpr std::array<std::pair<int, const char*>, 10> s_reasonBits = {{
+    {dd4hep::sim::G4PARTICLE_CREATED_HIT,              "CreatedHit"},
+    {dd4hep::sim::G4PARTICLE_PRIMARY,                  "Primary"},
+    {dd4hep::sim::G4PARTICLE_HAS_SECONDARIES,          "HasSecondaries"},
+    {dd4hep::sim::G4PARTICLE_ABOVE_ENERGY_THRESHOLD,   "AboveEnergyThreshold"},
+    {dd4hep::sim::G4PARTICLE_KEEP_PROCESS,             "KeepProcess"},
+    {dd4hep::sim::G4PARTICLE_KEEP_PARENT,              "KeepParent"},
+    {dd4hep::sim::G4PARTICLE_CREATED_CALORIMETER_HIT,  "CreatedCalorimeterHit"},
+    {dd4hep::sim::G4PARTICLE_CREATED_TRACKER_HIT,      "CreatedTrackerHit"},
+    {dd4hep::sim::G4PARTICLE_KEEP_USER,                "KeepUser"},
+    {dd4hep::sim::G4PARTICLE_KEEP_ALWAYS,              "KeepAlways"},
+  }};
+
   /// EIC user particle handler: tracking-volume filter plus a regional
   /// forward/backward low-|p| cut.
   /**
@@ -49,28 +81,102 @@ namespace npdet::sim {
   class Geant4TVEicParticleHandler : public dd4hep::sim::Geant4UserParticleHandler {
     dd4hep::Volume m_trackingVolume;
 
+    /// Grid classifier for the tracking-volume shape, shared by all threads and
+    /// only built once FastContainment is used
+    std::shared_ptr<const TrackingVolumeClassifier> m_trackingVolumeClassifier;
+
     double m_forwardZ{335 * dd4hep::cm};               ///< +Z dead-zone boundary (positive)
     double m_backwardZ{-175 * dd4hep::cm};             ///< -Z dead-zone boundary (negative)
     double m_forwardMomentumMin{100 * dd4hep::MeV};    ///< |p| threshold in +Z dead zone
     double m_backwardMomentumMin{100 * dd4hep::MeV};   ///< |p| threshold in -Z dead zone
 
+    /// Additional (r,z) regions with their own thresholds, one specification
+    /// string per region (see RegionCutTable::parse). Values in DD4hep units.
+    std::vector<std::string> m_regionCuts;
+    /// Region specifications the compiled table was built from
+    std::vector<std::string> m_compiledRegionCuts;
+    /// Compiled region table, in Geant4 units (mm, MeV)
+    RegionCutTable m_regionTable;
+
     /// If true, particles carrying G4PARTICLE_CREATED_CALORIMETER_HIT are saved
     /// (preserves full calo shower MC truth at the cost of much larger MCParticles collections).
     /// Default false — upstream policy
     bool m_keepCaloHitParticles{false};
 
+    /// If true, use the precomputed grid classifier for the tracking-volume test;
+    /// if false, use the exact TGeo shape test (for cross-validation).
+    bool m_fastContainment{true};
+
+    /// Upper bound on the number of classifier grid cells (one byte each)
+    static constexpr std::size_t s_maxClassifierCells{1 << 20};
+
+    /// Regional cut thresholds converted to Geant4/CLHEP units (mm, MeV^2).
+    /// Refreshed at the start of every event, so that the per-track path
+    /// compares raw Geant4Particle fields without any unit conversion.
+    struct {
+      double forwardZ{0.}, backwardZ{0.};
+      double forwardMomentumMin2{0.}, backwardMomentumMin2{0.};
+    } m_cut;
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Per-run counters of this handler instance (one instance per worker thread)
+    struct {
+      std::size_t                                    seen{0};
+      std::size_t                                    kept{0};
+      std::size_t                                    droppedTrackingVolume{0};
+      std::size_t                                    droppedForward{0};
+      std::size_t                                    droppedBackward{0};
+      std::vector<std::size_t>                       droppedRegion;
+      std::size_t                                    backscatter{0};
+      std::array<std::size_t, s_reasonBits.size()>   keptReason{};
+      Clock::duration                                containmentTime{0};
+    } m_stats;
+
+    /// Property: Counters of this instance in the last run, refreshed at the end of every run
+    std::map<std::string, double> m_statistics;
+    /// Property: If set, write the counters of all instances as JSON to this file at the end of every run
+    std::string m_statisticsFile;
+    /// Property: Accumulate the time spent in the tracking-volume containment tests
+    bool m_timeContainment{false};
+
+    /// Counters of all instances with the same name in one run
+    using Statistics = std::map<std::string, double>;
+    std::shared_ptr<RunSummary<Statistics>> m_summary;
+
+    /// True if the point (DD4hep units) is inside the tracking volume
+    bool inTrackingVolume(const double* point) const {
+      return m_fastContainment ? m_trackingVolumeClassifier->contains(point)
+                               : m_trackingVolume.ptr()->Contains(point);
+    }
+
   public:
 
     Geant4TVEicParticleHandler(dd4hep::sim::Geant4Context* ctxt, const std::string& nam);
 
     /// Default destructor
-    ~Geant4TVEicParticleHandler() override = default;
+    ~Geant4TVEicParticleHandler() override;
+
+    using dd4hep::sim::Geant4UserParticleHandler::begin;
+    using dd4hep::sim::Geant4UserParticleHandler::end;
+
+    /// (Re)build the region table from the RegionCuts property
+    void compileRegionCuts();
+    /// EIC regional cut, applied after the standard tracking-volume filter
+    void applyRegionalCuts(Particle& p);
+    /// Copy the counters into the Statistics property and reset them
+    void updateStatistics();
+    /// Print the statistics of all instances and write the optional JSON summary
+    void writeStatistics(const Statistics& statistics, int run) const;
+
+    /// End-of-run callback: merge the counters of this run into the totals of all instances
+    void endRun(const G4Run* run);
+
+    /// Pre-event action callback: convert the cut properties to Geant4 units
+    void begin(const G4Event* event) override;
 
     /// Post-track action callback
     void end(const G4Track* track, Particle& particle) override;
-
-    /// Post-event action callback (overload to avoid -Woverloaded-virtual)
-    void end(const G4Event* event) override;
   };
 
   // ------------------------------------------------------------------
@@ -143,6 +249,29 @@ namespace npdet::sim {
       }
     }
 
+    /// A string as a JSON string literal
+    std::string jsonString(const std::string& value) {
+      std::string out = "\"";
+      for (const char c : value) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+            out += code;
+          } else {
+            out += c;
+          }
+        }
+      }
+      return out + "\"";
+    }
+
   } // anonymous namespace
 
   /// Standard constructor
@@ -154,12 +283,78 @@ namespace npdet::sim {
              "ePIC users: consider running with a more recent version of the ePIC geometry "
              "or setting --part.userParticleHandler=Geant4TCUserParticleHandler");
     }
-
     declareProperty("ForwardRegionZ", m_forwardZ);
     declareProperty("ForwardMomentumMin", m_forwardMomentumMin);
     declareProperty("BackwardRegionZ", m_backwardZ);
     declareProperty("BackwardMomentumMin", m_backwardMomentumMin);
+    declareProperty("RegionCuts", m_regionCuts);
     declareProperty("KeepCaloHitParticles", m_keepCaloHitParticles);
+    declareProperty("FastContainment", m_fastContainment);
+    declareProperty("Statistics", m_statistics);
+    declareProperty("StatisticsFile", m_statisticsFile);
+    declareProperty("TimeContainment", m_timeContainment);
+    m_summary = RunSummary<Statistics>::attach(this, &Geant4TVEicParticleHandler::endRun);
+  }
+
+  /// Default destructor
+  Geant4TVEicParticleHandler::~Geant4TVEicParticleHandler() {
+    m_summary->detach();
+  }
+
+  /// (Re)build the region table from the RegionCuts property
+  void Geant4TVEicParticleHandler::compileRegionCuts() {
+    constexpr double mmDD4hepToCLHEP  = CLHEP::mm  / dd4hep::mm;
+    constexpr double MeVDD4hepToCLHEP = CLHEP::MeV / dd4hep::MeV;
+    m_regionTable.clear();
+    for (const auto& spec : m_regionCuts) {
+      RegionCutTable::Region region;
+      try {
+        region = RegionCutTable::parse(spec);
+      } catch (const std::exception& e) {
+        except("Invalid RegionCuts entry '%s': %s", spec.c_str(), e.what());
+      }
+      region.zmin        *= mmDD4hepToCLHEP;
+      region.zmax        *= mmDD4hepToCLHEP;
+      region.rmin        *= mmDD4hepToCLHEP;
+      region.rmax        *= mmDD4hepToCLHEP;
+      region.momentumMin *= MeVDD4hepToCLHEP;
+      region.energyMin   *= MeVDD4hepToCLHEP;
+      info("Region cut %-12s z [%g, %g) cm, r [%g, %g) cm, |p| >= %g GeV, Ekin >= %g GeV, %zu PDG codes",
+           region.name.c_str(), region.zmin / CLHEP::cm, region.zmax / CLHEP::cm,
+           region.rmin / CLHEP::cm, region.rmax / CLHEP::cm,
+           region.momentumMin / CLHEP::GeV, region.energyMin / CLHEP::GeV, region.pdg.size());
+      m_regionTable.add(std::move(region));
+    }
+    m_regionTable.compile();
+    m_compiledRegionCuts = m_regionCuts;
+    m_stats.droppedRegion.resize(m_regionTable.regions().size());
+  }
+
+  /// Pre-event action callback.
+  ///
+  /// Properties may be changed by the steering after construction, so the
+  /// derived per-track thresholds are recomputed here once per event, and
+  /// the tracking-volume classifier is only built (or taken from another
+  /// thread) once FastContainment is set.
+  void Geant4TVEicParticleHandler::begin(const G4Event* /* event */) {
+    constexpr double mmDD4hepToCLHEP  = CLHEP::mm  / dd4hep::mm;
+    constexpr double MeVDD4hepToCLHEP = CLHEP::MeV / dd4hep::MeV;
+    const double pfwd = m_forwardMomentumMin * MeVDD4hepToCLHEP;
+    const double pbwd = m_backwardMomentumMin * MeVDD4hepToCLHEP;
+    m_cut.forwardZ             = m_forwardZ * mmDD4hepToCLHEP;
+    m_cut.backwardZ            = m_backwardZ * mmDD4hepToCLHEP;
+    m_cut.forwardMomentumMin2  = pfwd * pfwd;
+    m_cut.backwardMomentumMin2 = pbwd * pbwd;
+    if (m_regionCuts != m_compiledRegionCuts) {
+      compileRegionCuts();
+    }
+    if (m_fastContainment && !m_trackingVolumeClassifier) {
+      m_trackingVolumeClassifier = TrackingVolumeClassifier::shared(m_trackingVolume.solid().ptr(), s_maxClassifierCells);
+      const auto cell = m_trackingVolumeClassifier->cellSize();
+      debug("Tracking-volume classifier: %zu cells of (%.2f, %.2f, %.2f) cm, %.1f%% on the boundary",
+            m_trackingVolumeClassifier->size(), cell[0] / dd4hep::cm, cell[1] / dd4hep::cm, cell[2] / dd4hep::cm,
+            100. * m_trackingVolumeClassifier->boundaryFraction());
+    }
   }
 
   /// Post-track action callback.
@@ -168,36 +363,66 @@ namespace npdet::sim {
   ///   1. Standard DD4hep tracking-volume filter (setReason +
   ///      setSimulatorStatus) using the `tracking_volume` from the detector
   ///      description.
-  ///   2. EIC regional cut: drop low-|p| particles ending in the far
-  ///      forward/backward Z regions, after the must-keep guards.
+  ///   2. EIC regional cut (applyRegionalCuts).
   void Geant4TVEicParticleHandler::end(const G4Track* /* track */, Particle& p) {
     // Geant4Particle fields are stored in CLHEP/Geant4 units (mm, MeV).
-    // We compare against properties that arrive from ddsim Python steering
-    // already expressed in DD4hep units (cm, GeV). The explicit bridge is:
+    // The tracking-volume test works in DD4hep units (cm). The explicit
+    // bridge is:
     //
     //   value_in_dd4hep = raw_field / CLHEP::<unit> * dd4hep::<unit>
     //
-    // i.e. strip the Geant4 unit, then re-apply the DD4hep one.
+    // i.e. strip the Geant4 unit, then re-apply the DD4hep one. The regional
+    // cut instead compares the raw fields against thresholds converted once
+    // per event in begin(const G4Event*).
     constexpr double mmCLHEPtoDD4hep  = dd4hep::mm  / CLHEP::mm;
-    constexpr double MeVCLHEPtoDD4hep = dd4hep::MeV / CLHEP::MeV;
 
-    // Positions for TGeoVolume::Contains (which works in DD4hep/ROOT units).
+    ++m_stats.seen;
+
+    // Positions for the tracking-volume test (which works in DD4hep/ROOT units).
+    const auto t0 = m_timeContainment ? Clock::now() : Clock::time_point{};
     std::array<double, 3> start_point = {p.vsx * mmCLHEPtoDD4hep,
                                          p.vsy * mmCLHEPtoDD4hep,
                                          p.vsz * mmCLHEPtoDD4hep};
-    bool starts_in_trk_vol = m_trackingVolume.ptr()->Contains(start_point.data());
+    bool starts_in_trk_vol = inTrackingVolume(start_point.data());
     std::array<double, 3> end_point   = {p.vex * mmCLHEPtoDD4hep,
                                          p.vey * mmCLHEPtoDD4hep,
                                          p.vez * mmCLHEPtoDD4hep};
-    bool ends_in_trk_vol   = m_trackingVolume.ptr()->Contains(end_point.data());
+    bool ends_in_trk_vol   = inTrackingVolume(end_point.data());
+    if (m_timeContainment) {
+      m_stats.containmentTime += Clock::now() - t0;
+    }
 
+    const bool had_reason = p.reason != 0;
     setReason(p, starts_in_trk_vol, ends_in_trk_vol);
     setSimulatorStatus(p, starts_in_trk_vol, ends_in_trk_vol);
+    if (had_reason && p.reason == 0) {
+      ++m_stats.droppedTrackingVolume;
+    }
+    if (!starts_in_trk_vol && ends_in_trk_vol) {
+      ++m_stats.backscatter;
+    }
+
+    applyRegionalCuts(p);
+
+    if (p.reason != 0) {
+      ++m_stats.kept;
+      for (std::size_t i = 0; i < s_reasonBits.size(); ++i) {
+        if ((p.reason & s_reasonBits[i].first) != 0) {
+          ++m_stats.keptReason[i];
+        }
+      }
+    }
+  }
 
-    // ----- EIC-specific extra cut --------------------------------------
+  /// EIC regional cut: drop low-|p| particles ending in the far
+  /// forward/backward Z regions or below the thresholds of the matching
+  /// RegionCuts entry, after the must-keep guards.
+  void Geant4TVEicParticleHandler::applyRegionalCuts(Particle& p) {
     // Drop low-momentum particles that ended in the far forward or far
-    // backward Z regions. All thresholds (m_forwardZ, m_backwardZ,
-    // m_forwardMomentumMin, m_backwardMomentumMin) are in DD4hep units.
+    // backward Z regions. The thresholds in m_cut are in Geant4 units.
+
+    // Nothing to do for particles already dropped by the standard filter.
+    if (p.reason == 0) return;
 
     // Respect upstream "must-keep" reasons before zeroing.
     dd4hep::detail::ReferenceBitMask<int> reason(p.reason);
@@ -206,17 +431,94 @@ namespace npdet::sim {
     if (reason.isSet(dd4hep::sim::G4PARTICLE_CREATED_TRACKER_HIT)) return;
     if (m_keepCaloHitParticles && reason.isSet(dd4hep::sim::G4PARTICLE_CREATED_CALORIMETER_HIT)) return;
 
-    const double pmag2 = (p.psx * p.psx + p.psy * p.psy + p.psz * p.psz) * (MeVCLHEPtoDD4hep * MeVCLHEPtoDD4hep);
-    const double endZ  = p.vez * mmCLHEPtoDD4hep;
+    const double pmag2 = p.psx * p.psx + p.psy * p.psy + p.psz * p.psz;
 
-    if ((endZ > m_forwardZ  && pmag2 < m_forwardMomentumMin * m_forwardMomentumMin) ||
-        (endZ < m_backwardZ && pmag2 < m_backwardMomentumMin * m_backwardMomentumMin)) {
+    if (p.vez > m_cut.forwardZ && pmag2 < m_cut.forwardMomentumMin2) {
+      p.reason = 0;
+      ++m_stats.droppedForward;
+      return;
+    }
+    if (p.vez < m_cut.backwardZ && pmag2 < m_cut.backwardMomentumMin2) {
       p.reason = 0;
+      ++m_stats.droppedBackward;
+      return;
     }
+
+    // User-defined (r,z) regions: first matching region decides.
+    if (!m_regionTable.empty()) {
+      const auto* region = m_regionTable.find(std::hypot(p.vex, p.vey), p.vez, p.pdgID);
+      if (region != nullptr) {
+        if (pmag2 < region->momentumMin * region->momentumMin ||
+            (region->energyMin > 0. && std::sqrt(pmag2 + p.mass * p.mass) - p.mass < region->energyMin)) {
+          p.reason = 0;
+          ++m_stats.droppedRegion[region - m_regionTable.regions().data()];
+        }
+      }
+    }
+  }
+
+  /// Copy the counters into the Statistics property and reset them
+  void Geant4TVEicParticleHandler::updateStatistics() {
+    m_statistics.clear();
+    m_statistics["seen"]                    = m_stats.seen;
+    m_statistics["kept"]                    = m_stats.kept;
+    m_statistics["dropped_tracking_volume"] = m_stats.droppedTrackingVolume;
+    m_statistics["dropped_forward"]         = m_stats.droppedForward;
+    m_statistics["dropped_backward"]        = m_stats.droppedBackward;
+    m_statistics["backscatter"]             = m_stats.backscatter;
+    for (std::size_t i = 0; i < s_reasonBits.size(); ++i) {
+      m_statistics[std::string("kept_reason_") + s_reasonBits[i].second] = m_stats.keptReason[i];
+    }
+    const auto& regions = m_regionTable.regions();
+    for (std::size_t i = 0; i < regions.size() && i < m_stats.droppedRegion.size(); ++i) {
+      m_statistics["dropped_region_" + regions[i].name] = m_stats.droppedRegion[i];
+    }
+    if (m_timeContainment) {
+      m_statistics["containment_time_s"] = std::chrono::duration<double>(m_stats.containmentTime).count();
+    }
+    auto droppedRegion = std::move(m_stats.droppedRegion);
+    m_stats = {};
+    m_stats.droppedRegion.assign(droppedRegion.size(), 0);
+  }
+
+  /// End-of-run callback.
+  ///
+  /// The counters are only collected here: the keep/drop decision cannot be
+  /// deferred to the end of the event, see "Why the filter runs per track"
+  /// in Geant4TVEicParticleHandler.md, and there is nothing to do per event.
+  void Geant4TVEicParticleHandler::endRun(const G4Run* run) {
+    updateStatistics();
+    m_summary->endOfRun(
+        [this](Statistics& totals) {
+          for (const auto& [key, value] : m_statistics) {
+            totals[key] += value;
+          }
+        },
+        [this, run](Statistics& totals) { writeStatistics(totals, run->GetRunID()); });
   }
 
-  /// Post-event action callback
-  void Geant4TVEicParticleHandler::end(const G4Event* /* event */) {}
+  /// Print the statistics of all instances and write the optional JSON summary
+  void Geant4TVEicParticleHandler::writeStatistics(const Statistics& statistics, int run) const {
+    for (const auto& [key, value] : statistics) {
+      info("%-32s %.15g", key.c_str(), value);
+    }
+    if (m_statisticsFile.empty()) {
+      return;
+    }
+    const auto file_name = runFileName(m_statisticsFile, run);
+    std::ofstream out(file_name);
+    if (!out) {
+      error("Cannot write statistics summary to %s", file_name.c_str());
+      return;
+    }
+    out << "{\n";
+    std::size_t n = 0;
+    for (const auto& [key, value] : statistics) {
+      out << "  " << jsonString(key) << ": " << std::setprecision(15) << value
+          << (++n < statistics.size() ? ",\n" : "\n");
+    }
+    out << "}\n";
+  }
 
 } // namespace npdet::sim
 
@@ -0,0 +1,419 @@
+#include "DDG4/Factories.h"
+
+// Framework include files
+#include "DD4hep/Printout.h"
+#include "DDG4/Geant4Particle.h"
+#include "DDG4/Geant4Vertex.h"
+#include "npdet/GeneratorStatus.h"
+#include "npdet/HEPMC3PrefetchReader.h"
+#include "npdet/HepMC3EventIndex.h"
+
+// Geant4 include files
+#include "CLHEP/Units/PhysicalConstants.h"
+#include "CLHEP/Units/SystemOfUnits.h"
+
+// C/C++ include files
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+// POSIX include files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace npdet::sim {
+
+using namespace dd4hep::sim;
+
+namespace {
+
+  constexpr std::string_view s_version = "HepMC::Version";
+  constexpr std::string_view s_start   = "HepMC::Asciiv3-START_EVENT_LISTING";
+
+  /// Start of the next line starting with c after p, or end
+  const char* next_record(const char* p, const char* end, char c) {
+    const char pattern[2] = {'\n', c};
+    std::string_view text(p, end - p);
+    const std::size_t pos = text.find(std::string_view(pattern, 2));
+    return pos == std::string_view::npos ? end : p + pos + 1;
+  }
+
+  /// Whitespace separated fields of one record
+  class Fields {
+  public:
+    explicit Fields(std::string_view line) : m_line(line) {}
+
+    std::string_view word() {
+      const std::size_t first = m_line.find_first_not_of(" \t\r");
+      if (first == std::string_view::npos) {
+        m_line = {};
+        return {};
+      }
+      m_line = m_line.substr(first);
+      const std::size_t last = std::min(m_line.find_first_of(" \t\r"), m_line.size());
+      std::string_view w = m_line.substr(0, last);
+      m_line             = m_line.substr(last);
+      return w;
+    }
+    template <typename T> bool number(T& value) {
+      const std::string_view w = word();
+      const auto [ptr, ec]     = std::from_chars(w.data(), w.data() + w.size(), value);
+      return !w.empty() && ec == std::errc() && ptr == w.data() + w.size();
+    }
+    /// Position "@ x y z t" if the rest of the record has one
+    bool position(double (&pos)[4]) {
+      const std::size_t at = m_line.find('@');
+      if (at == std::string_view::npos) return false;
+      m_line = m_line.substr(at + 1);
+      return number(pos[0]) && number(pos[1]) && number(pos[2]) && number(pos[3]);
+    }
+    std::string_view rest() const { return m_line; }
+
+  private:
+    std::string_view m_line;
+  };
+
+  /// Vertex of the HepMC3 record: explicit (V record) or implied by a single parent particle
+  struct RawVertex {
+    bool             has_position = false;
+    double           pos[4]       = {0, 0, 0, 0};
+    std::vector<int> in, out;
+  };
+
+  /// Particle of the HepMC3 record
+  struct RawParticle {
+    int    production = -1;   ///< Index into the vertices, -1 for none
+    int    end        = -1;
+    int    pdg        = 0;
+    int    status     = 0;
+    double p[3]       = {0, 0, 0};
+    double mass       = 0;
+  };
+
+  /// Convert one event record (from its E line to the next one) to DDG4 particles and vertices
+  std::string convert_record(std::string_view text, HEPMC3PrefetchReader::Vertices& vertices,
+                             HEPMC3PrefetchReader::Particles& particles) {
+    std::vector<RawParticle> raw_particles;
+    std::vector<RawVertex>   raw_vertices;
+    std::vector<int>         vertex_index;   // -id - 1 of explicit vertices -> index into raw_vertices
+    double event_pos[4]  = {0, 0, 0, 0};
+    bool   has_event_pos = false;
+    double mom_unit = CLHEP::GeV, len_unit = CLHEP::mm;
+
+    auto vertex_of_id = [&](int id) -> int {
+      const std::size_t i = -id - 1;
+      if (i >= vertex_index.size()) vertex_index.resize(i + 1, -1);
+      if (vertex_index[i] < 0) {
+        vertex_index[i] = raw_vertices.size();
+        raw_vertices.emplace_back();
+      }
+      return vertex_index[i];
+    };
+
+    for (std::size_t pos = 0; pos < text.size();) {
+      std::size_t eol = text.find('\n', pos);
+      if (eol == std::string_view::npos) eol = text.size();
+      const std::string_view line = text.substr(pos, eol - pos);
+      pos = eol + 1;
+      if (line.empty()) continue;
+      Fields f(line.substr(1));
+      switch (line[0]) {
+      case 'E':
+        has_event_pos = f.position(event_pos);
+        break;
+      case 'U': {
+        const std::string_view mom = f.word(), len = f.word();
+        mom_unit = mom == "MEV" ? CLHEP::MeV : CLHEP::GeV;
+        len_unit = len == "CM" ? CLHEP::cm : CLHEP::mm;
+        break;
+      }
+      case 'P': {
+        int id = 0, mother = 0;
+        RawParticle p;
+        double e = 0;
+        if (!(f.number(id) && f.number(mother) && f.number(p.pdg) && f.number(p.p[0]) && f.number(p.p[1]) &&
+              f.number(p.p[2]) && f.number(e) && f.number(p.mass) && f.number(p.status)) ||
+            id != int(raw_particles.size()) + 1) {
+          return "Invalid particle record: " + std::string(line);
+        }
+        if (mother < 0) {
+          p.production = vertex_of_id(mother);
+        } else if (mother > 0) {
+          if (mother > int(raw_particles.size())) return "Unknown parent particle: " + std::string(line);
+          // Single parent particle: its end vertex, created without a position if needed
+          RawParticle& parent = raw_particles[mother - 1];
+          if (parent.end < 0) {
+            parent.end = raw_vertices.size();
+            raw_vertices.emplace_back();
+            raw_vertices.back().in.push_back(mother - 1);
+          }
+          p.production = parent.end;
+        }
+        if (p.production >= 0) raw_vertices[p.production].out.push_back(id - 1);
+        raw_particles.push_back(p);
+        break;
+      }
+      case 'V': {
+        int id = 0, status = 0;
+        if (!(f.number(id) && f.number(status)) || id >= 0) return "Invalid vertex record: " + std::string(line);
+        const int v = vertex_of_id(id);
+        // Incoming particles: [i1,i2,...]
+        std::string_view rest = f.rest();
+        const std::size_t open = rest.find('['), close = rest.find(']');
+        if (open != std::string_view::npos && close != std::string_view::npos && close > open) {
+          std::string_view list = rest.substr(open + 1, close - open - 1);
+          while (!list.empty()) {
+            const std::size_t comma = std::min(list.find(','), list.size());
+            int in = 0;
+            std::from_chars(list.data(), list.data() + comma, in);
+            if (in < 1 || in > int(raw_particles.size())) return "Unknown incoming particle: " + std::string(line);
+            raw_particles[in - 1].end = v;
+            raw_vertices[v].in.push_back(in - 1);
+            list = comma < list.size() ? list.substr(comma + 1) : std::string_view();
+          }
+        }
+        RawVertex& vtx   = raw_vertices[v];
+        vtx.has_position = f.position(vtx.pos);
+        if (vtx.has_position && !has_event_pos) {
+          // As scripts/sanitize_hepmc3.py: the first vertex with a position is the event position
+          std::copy(vtx.pos, vtx.pos + 4, event_pos);
+          has_event_pos = true;
+        }
+        break;
+      }
+      default:
+        // W, A, T, N and the end of the listing carry nothing for the simulation
+        break;
+      }
+    }
+
+    // Vertices without a position inherit that of the production vertex of their first incoming particle
+    auto position = [&](auto&& self, int v) -> const double* {
+      if (v < 0) return event_pos;
+      RawVertex& vtx = raw_vertices[v];
+      if (!vtx.has_position) {
+        const double* inherited = vtx.in.empty() ? event_pos : self(self, raw_particles[vtx.in.front()].production);
+        std::copy(inherited, inherited + 4, vtx.pos);
+        vtx.has_position = true;
+      }
+      return vtx.pos;
+    };
+
+    for (std::size_t i = 0; i < raw_particles.size(); ++i) {
+      const RawParticle& raw = raw_particles[i];
+      Geant4ParticleHandle p(new Geant4Particle(int(i)));
+      const double* vs = position(position, raw.production);
+      const double* ve = raw.end >= 0 ? position(position, raw.end) : vs;
+      p->pdgID  = raw.pdg;
+      // Geant4 takes the charge from the particle definition
+      p->charge = 0;
+      p->psx    = p->pex = raw.p[0] * mom_unit;
+      p->psy    = p->pey = raw.p[1] * mom_unit;
+      p->psz    = p->pez = raw.p[2] * mom_unit;
+      p->mass   = raw.mass * mom_unit;
+      p->vsx    = vs[0] * len_unit;
+      p->vsy    = vs[1] * len_unit;
+      p->vsz    = vs[2] * len_unit;
+      p->time   = vs[3] * len_unit / CLHEP::c_light;
+      p->vex    = ve[0] * len_unit;
+      p->vey    = ve[1] * len_unit;
+      p->vez    = ve[2] * len_unit;
+      p->process   = 0;
+      p->genStatus = raw.status & G4PARTICLE_GEN_STATUS_MASK;
+      if (raw.production >= 0) {
+        for (int parent : raw_vertices[raw.production].in) p->parents.insert(parent);
+      }
+      if (raw.end >= 0) {
+        for (int daughter : raw_vertices[raw.end].out) p->daughters.insert(daughter);
+      }
+      setGeneratorStatus(*p);
+      // Particles without parents start from their own vertex
+      if (p->parents.empty()) {
+        Geant4Vertex* vtx = new Geant4Vertex();
+        vtx->x    = p->vsx;
+        vtx->y    = p->vsy;
+        vtx->z    = p->vsz;
+        vtx->time = p->time;
+        vtx->out.insert(p->id);
+        vertices.push_back(vtx);
+      }
+      particles.push_back(p);
+    }
+    return {};
+  }
+
+} // namespace
+
+/// Convert one event record (from its E line to the next one); returns the error, empty on success
+std::string HEPMC3PrefetchReader::convert(std::string_view record, Vertices& vertices, Particles& particles) {
+  return convert_record(record, vertices, particles);
+}
+
+/// Initializing constructor
+HEPMC3PrefetchReader::HEPMC3PrefetchReader(const std::string& nam) : Geant4EventReader(nam) {
+  printout(dd4hep::INFO, "HEPMC3PrefetchReader", "Created file reader. Try to open input %s", nam.c_str());
+}
+
+/// Default destructor
+HEPMC3PrefetchReader::~HEPMC3PrefetchReader() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stop = true;
+  }
+  m_cond.notify_all();
+  for (auto& t : m_pool) t.join();
+  for (auto& event : m_ring) clear(event);
+  if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+/// Read Threads and Depth
+Geant4EventReader::EventReaderStatus HEPMC3PrefetchReader::setParameters(std::map<std::string, std::string>& parameters) {
+  _getParameterValue(parameters, "Threads", m_threads, std::size_t(2));
+  _getParameterValue(parameters, "Depth", m_depth, std::size_t(64));
+  m_threads = std::max<std::size_t>(m_threads, 1);
+  m_depth   = std::max<std::size_t>(m_depth, 1);
+  return EVENT_READER_OK;
+}
+
+/// Release all particles and vertices of an event
+void HEPMC3PrefetchReader::clear(Event& event) {
+  for (auto* p : event.particles) delete p;
+  for (auto* v : event.vertices) delete v;
+  event.particles.clear();
+  event.vertices.clear();
+  event.error.clear();
+  event.ready = false;
+}
+
+/// Map the file and start the parsing threads
+void HEPMC3PrefetchReader::start() {
+  const int fd = ::open(m_name.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size == 0) {
+    m_openError = "Cannot open " + m_name + ": " + std::strerror(errno);
+    if (fd >= 0) ::close(fd);
+    return;
+  }
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_openError = "Cannot map " + m_name + ": " + std::strerror(errno);
+    return;
+  }
+  ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+  m_data = static_cast<const char*>(data);
+  m_size = st.st_size;
+  m_end  = m_data + m_size;
+
+  const std::string_view text(m_data, m_size);
+  const std::size_t      first_end = text.find('\n');
+  if (text.substr(0, first_end).find(s_version) == std::string_view::npos ||
+      text.substr(first_end + 1, s_start.size()) != s_start) {
+    m_openError = m_name + " is not a HepMC3 ASCII file";
+    return;
+  }
+  m_cursor = next_record(m_data, m_end, 'E');
+  HepMC3EventIndex index;
+  if (m_skip > 0 && HepMC3EventIndex::load(m_name, index) && index.file_size == m_size) {
+    printout(dd4hep::INFO, "HEPMC3PrefetchReader", "++ Seeking to event %zu with index %s", m_skip,
+             HepMC3EventIndex::path(m_name).c_str());
+    m_cursor = m_skip < index.offsets.size() ? m_data + index.offsets[m_skip] : m_end;
+    m_skip   = 0;
+  }
+  for (; m_skip > 0 && m_cursor != m_end; --m_skip) {
+    m_cursor = next_record(m_cursor, m_end, 'E');
+  }
+  m_ring.resize(m_depth);
+  for (std::size_t i = 0; i < m_threads; ++i) {
+    m_pool.emplace_back(&HEPMC3PrefetchReader::work, this);
+  }
+  printout(dd4hep::INFO, "HEPMC3PrefetchReader", "Parsing %s with %zu threads, %zu events ahead", m_name.c_str(), m_threads,
+           m_depth);
+}
+
+/// Parsing thread: claim the next event record, convert it, mark its slot ready
+void HEPMC3PrefetchReader::work() {
+  std::unique_lock<std::mutex> lock(m_lock);
+  for (;;) {
+    m_cond.wait(lock, [this] { return m_stop || m_cursor == m_end || m_claimed - m_consumed < m_depth; });
+    if (m_stop || m_cursor == m_end) return;
+    const std::size_t n    = m_claimed++;
+    const char*       next = next_record(m_cursor, m_end, 'E');
+    const std::string_view text(m_cursor, next - m_cursor);
+    m_cursor = next;
+    if (m_cursor == m_end) m_cond.notify_all();
+    lock.unlock();
+
+    Event& event = m_ring[n % m_depth];
+    event.error  = convert(text, event.vertices, event.particles);
+
+    lock.lock();
+    event.ready = true;
+    m_cond.notify_all();
+  }
+}
+
+/// Skip the first events without parsing them
+Geant4EventReader::EventReaderStatus HEPMC3PrefetchReader::moveToEvent(int event_number) {
+  if (m_currEvent == 0 && event_number > 0 && m_pool.empty() && m_openError.empty()) {
+    printout(dd4hep::INFO, "HEPMC3PrefetchReader", "++ Skipping the first %d events", event_number);
+    m_skip      = event_number;
+    m_currEvent = event_number;
+  }
+  return EVENT_READER_OK;
+}
+
+/// Drop the next event
+Geant4EventReader::EventReaderStatus HEPMC3PrefetchReader::skipEvent() {
+  Vertices  vertices;
+  Particles particles;
+  const EventReaderStatus sc = readParticles(m_currEvent + 1, vertices, particles);
+  for (auto* p : particles) delete p;
+  for (auto* v : vertices) delete v;
+  return sc;
+}
+
+/// Hand over the next event in file order
+Geant4EventReader::EventReaderStatus HEPMC3PrefetchReader::readParticles(int /* event_number */, Vertices& vertices,
+                                                                         Particles& particles) {
+  if (!m_data && m_openError.empty()) start();
+  if (!m_openError.empty()) {
+    printout(dd4hep::ERROR, "HEPMC3PrefetchReader", "%s", m_openError.c_str());
+    return EVENT_READER_IO_ERROR;
+  }
+
+  std::unique_lock<std::mutex> lock(m_lock);
+  Event& event = m_ring[m_consumed % m_depth];
+  m_cond.wait(lock, [&] { return event.ready || (m_cursor == m_end && m_consumed == m_claimed); });
+  if (!event.ready) {
+    return EVENT_READER_EOF;
+  }
+  // The slot stays ours until m_consumed moves past it
+  lock.unlock();
+
+  EventReaderStatus status = EVENT_READER_OK;
+  if (!event.error.empty()) {
+    printout(dd4hep::ERROR, "HEPMC3PrefetchReader", "Event %d: %s", m_currEvent, event.error.c_str());
+    status = EVENT_READER_ERROR;
+  } else {
+    vertices.insert(vertices.end(), event.vertices.begin(), event.vertices.end());
+    particles.insert(particles.end(), event.particles.begin(), event.particles.end());
+    event.vertices.clear();
+    event.particles.clear();
+  }
+  ++m_currEvent;
+
+  // Free the slot for the parsing threads
+  clear(event);
+  lock.lock();
+  ++m_consumed;
+  m_cond.notify_all();
+  return status;
+}
+
+} // namespace npdet::sim
+
+DECLARE_GEANT4_EVENT_READER_NS(npdet::sim, HEPMC3PrefetchReader)
@@ -2,4 +2,58 @@
 
 #include "npdet/OpticalPhotonEfficiencyStackingAction.h"
 
+// ROOT include files
+#include "TFile.h"
+#include "TTree.h"
+
+// C/C++ include files
+#include <fstream>
+#include <iomanip>
+
+namespace dd4hep::sim {
+
+  /// Write the per-volume breakdown: a TTree for .root files, a text table otherwise
+  void OpticalPhotonEfficiencyStackingAction::write_report(const std::string& file,
+                                                           const std::map<std::string, VolumeReport>& volumes) {
+    const bool root = file.size() > 5 && file.compare(file.size() - 5, 5, ".root") == 0;
+    if (root) {
+      TFile out(file.c_str(), "RECREATE");
+      if (out.IsZombie()) {
+        printout(ERROR, "OpticalPhotonEfficiencyStackingAction", "Cannot open report file %s", file.c_str());
+        return;
+      }
+      std::string volume, curve;
+      ULong64_t   total = 0, killed = 0;
+      // Owned and deleted by the file
+      auto* tree = new TTree("photons", "Optical photons per logical volume");
+      tree->Branch("volume", &volume);
+      tree->Branch("curve", &curve);
+      tree->Branch("total", &total);
+      tree->Branch("killed", &killed);
+      for (const auto& [name, report] : volumes) {
+        volume = name;
+        curve  = report.curve;
+        total  = report.total;
+        killed = report.killed;
+        tree->Fill();
+      }
+      out.Write();
+      out.Close();
+      return;
+    }
+    std::ofstream out(file);
+    if (!out) {
+      printout(ERROR, "OpticalPhotonEfficiencyStackingAction", "Cannot open report file %s", file.c_str());
+      return;
+    }
+    out << std::left << std::setw(40) << "# volume" << std::setw(24) << "curve" << std::right
+        << std::setw(16) << "total" << std::setw(16) << "killed" << '\n';
+    for (const auto& [name, report] : volumes) {
+      out << std::left << std::setw(40) << name << std::setw(24) << (report.curve.empty() ? "-" : report.curve)
+          << std::right << std::setw(16) << report.total << std::setw(16) << report.killed << '\n';
+    }
+  }
+
+} // namespace dd4hep::sim
+
 DECLARE_GEANT4ACTION(OpticalPhotonEfficiencyStackingAction)
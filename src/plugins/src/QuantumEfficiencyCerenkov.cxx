@@ -0,0 +1,192 @@
+#include "npdet/QuantumEfficiencyCerenkov.h"
+
+// Geant4 include files
+#include "G4DynamicParticle.hh"
+#include "G4LogicalVolume.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4ParticleChange.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Poisson.hh"
+#include "G4Region.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Version.hh"
+#include "Randomize.hh"
+#if G4VERSION_NUMBER >= 1100
+#include "G4PhysicsModelCatalog.hh"
+#endif
+
+// C/C++ include files
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace npdet::sim {
+
+  QuantumEfficiencyCerenkov::QuantumEfficiencyCerenkov(const G4String& name, double lambda_min,
+                                                       double lambda_max, const std::vector<double>& efficiency,
+                                                       const std::string& logical_volume,
+                                                       const std::string& region)
+    : G4Cerenkov(name) {
+    try {
+      m_curve = QuantumEfficiencyCurve::uniform(lambda_min, lambda_max, efficiency, CLHEP::hbarc * CLHEP::twopi);
+    } catch (const std::invalid_argument& e) {
+      throw std::invalid_argument("QuantumEfficiencyCerenkov: " + std::string(e.what()));
+    }
+    m_max_efficiency = std::clamp(m_curve.maximum(), 0., 1.);
+    constexpr auto flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+    try {
+      if (!logical_volume.empty()) m_logical_volume_regex.emplace(logical_volume, flags);
+      if (!region.empty()) m_region_regex.emplace(region, flags);
+    } catch (const std::regex_error& e) {
+      throw std::invalid_argument("QuantumEfficiencyCerenkov: invalid regex: " + std::string(e.what()));
+    }
+  }
+
+  /// True if the efficiency applies to photons generated in this logical volume
+  bool QuantumEfficiencyCerenkov::appliesTo(const G4LogicalVolume* lv) {
+    auto it = m_volume_matches.find(lv);
+    if (it == m_volume_matches.end()) {
+      const auto* region      = lv->GetRegion();
+      const auto  region_name = region == nullptr ? G4String{} : region->GetName();
+      const bool  match = (m_logical_volume_regex && std::regex_search(lv->GetName(), *m_logical_volume_regex)) ||
+                         (m_region_regex && std::regex_search(region_name, *m_region_regex));
+      it = m_volume_matches.emplace(lv, match).first;
+    }
+    return it->second;
+  }
+
+  /// Generate the (efficiency-weighted) Cerenkov photons of one step
+  /**
+   *  Follows G4Cerenkov::PostStepDoIt, with the mean number of photons scaled
+   *  by the maximum efficiency and an acceptance test on the sampled energy
+   *  before the photon is allocated.
+   */
+  G4VParticleChange* QuantumEfficiencyCerenkov::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep) {
+    G4StepPoint* pPreStepPoint  = aStep.GetPreStepPoint();
+    G4StepPoint* pPostStepPoint = aStep.GetPostStepPoint();
+    const auto*  pv             = pPreStepPoint->GetPhysicalVolume();
+    if (pv == nullptr || !appliesTo(pv->GetLogicalVolume())) {
+      return G4Cerenkov::PostStepDoIt(aTrack, aStep);
+    }
+
+    aParticleChange.Initialize(aTrack);
+
+    const G4DynamicParticle* aParticle = aTrack.GetDynamicParticle();
+    const G4Material*        aMaterial = aTrack.GetMaterial();
+
+    G4MaterialPropertiesTable* MPT = aMaterial->GetMaterialPropertiesTable();
+    if (MPT == nullptr) return pParticleChange;
+    G4MaterialPropertyVector* Rindex = MPT->GetProperty(kRINDEX);
+    if (Rindex == nullptr) return pParticleChange;
+
+    const G4double charge = aParticle->GetDefinition()->GetPDGCharge();
+    const G4double beta   = (pPreStepPoint->GetBeta() + pPostStepPoint->GetBeta()) * 0.5;
+
+    G4double MeanNumberOfPhotons = GetAverageNumberOfPhotons(charge, beta, aMaterial, Rindex);
+    // Only the photons that survive the efficiency are generated
+    MeanNumberOfPhotons *= aStep.GetStepLength() * m_max_efficiency;
+    const G4int NumPhotons = MeanNumberOfPhotons > 0. ? static_cast<G4int>(G4Poisson(MeanNumberOfPhotons)) : 0;
+#if G4VERSION_NUMBER >= 1070
+    const bool stack = GetStackPhotons();
+#else
+    // Photons are always stacked before StackPhotons was introduced
+    const bool stack = true;
+#endif
+    if (NumPhotons <= 0 || !stack) {
+      aParticleChange.SetNumberOfSecondaries(0);
+      return pParticleChange;
+    }
+
+    const G4double Pmin        = Rindex->Energy(0);
+    const G4double Pmax        = Rindex->GetMaxEnergy();
+    const G4double dp          = Pmax - Pmin;
+    const G4double nMax        = Rindex->GetMaxValue();
+    const G4double BetaInverse = 1. / beta;
+    const G4double maxCos      = BetaInverse / nMax;
+    const G4double maxSin2     = (1.0 - maxCos) * (1.0 + maxCos);
+
+    const G4double MeanNumberOfPhotons1 =
+        GetAverageNumberOfPhotons(charge, pPreStepPoint->GetBeta(), aMaterial, Rindex);
+    const G4double MeanNumberOfPhotons2 =
+        GetAverageNumberOfPhotons(charge, pPostStepPoint->GetBeta(), aMaterial, Rindex);
+
+    const G4ThreeVector x0 = pPreStepPoint->GetPosition();
+    const G4ThreeVector p0 = aStep.GetDeltaPosition().unit();
+    const G4double      t0 = pPreStepPoint->GetGlobalTime();
+#if G4VERSION_NUMBER >= 1100
+    static const G4int secID = G4PhysicsModelCatalog::GetModelID("model_Cerenkov");
+#endif
+
+    aParticleChange.SetNumberOfSecondaries(NumPhotons);
+    for (G4int i = 0; i < NumPhotons; ++i) {
+      G4double rand;
+      G4double sampledEnergy, sampledRI;
+      G4double cosTheta, sin2Theta;
+
+      // Sample an energy
+      do {
+        rand          = G4UniformRand();
+        sampledEnergy = Pmin + rand * dp;
+        sampledRI     = Rindex->Value(sampledEnergy);
+        cosTheta      = BetaInverse / sampledRI;
+        sin2Theta     = (1.0 - cosTheta) * (1.0 + cosTheta);
+        rand          = G4UniformRand();
+      } while (rand * maxSin2 > sin2Theta);
+
+      // Efficiency acceptance, before anything is allocated
+      if (!m_curve.covers(sampledEnergy) || G4UniformRand() * m_max_efficiency >= m_curve(sampledEnergy)) {
+        continue;
+      }
+
+      // Photon direction and polarization, first with respect to the primary
+      // direction along z, then rotated to the global frame
+      rand                    = G4UniformRand();
+      const G4double phi      = twopi * rand;
+      const G4double sinPhi   = std::sin(phi);
+      const G4double cosPhi   = std::cos(phi);
+      const G4double sinTheta = std::sqrt(sin2Theta);
+      G4ParticleMomentum photonMomentum(sinTheta * cosPhi, sinTheta * sinPhi, cosTheta);
+      photonMomentum.rotateUz(p0);
+      G4ThreeVector photonPolarization(cosTheta * cosPhi, cosTheta * sinPhi, -sinTheta);
+      photonPolarization.rotateUz(p0);
+
+      auto* aCerenkovPhoton = new G4DynamicParticle(G4OpticalPhoton::OpticalPhoton(), photonMomentum);
+      aCerenkovPhoton->SetPolarization(photonPolarization);
+      aCerenkovPhoton->SetKineticEnergy(sampledEnergy);
+
+      // Position along the step, following the photon yield at both ends
+      G4double NumberOfPhotons, N;
+      do {
+        rand            = G4UniformRand();
+        NumberOfPhotons = MeanNumberOfPhotons1 - rand * (MeanNumberOfPhotons1 - MeanNumberOfPhotons2);
+        N               = G4UniformRand() * std::max(MeanNumberOfPhotons1, MeanNumberOfPhotons2);
+      } while (N > NumberOfPhotons);
+
+      const G4double delta     = rand * aStep.GetStepLength();
+      const G4double deltaTime = delta / (pPreStepPoint->GetVelocity() +
+                                          rand * (pPostStepPoint->GetVelocity() - pPreStepPoint->GetVelocity()) * 0.5);
+
+      auto* aSecondaryTrack = new G4Track(aCerenkovPhoton, t0 + deltaTime, x0 + rand * aStep.GetDeltaPosition());
+      aSecondaryTrack->SetTouchableHandle(pPreStepPoint->GetTouchableHandle());
+      aSecondaryTrack->SetParentID(aTrack.GetTrackID());
+#if G4VERSION_NUMBER >= 1100
+      aSecondaryTrack->SetCreatorModelID(secID);
+#endif
+      aParticleChange.AddSecondary(aSecondaryTrack);
+    }
+
+    if (GetTrackSecondariesFirst() && aTrack.GetTrackStatus() == fAlive) {
+      aParticleChange.ProposeTrackStatus(fSuspend);
+    }
+    if (verboseLevel > 1) {
+      G4cout << GetProcessName() << ": " << aParticleChange.GetNumberOfSecondaries()
+             << " of " << NumPhotons << " photons generated after efficiency" << G4endl;
+    }
+    return pParticleChange;
+  }
+
+} // namespace npdet::sim
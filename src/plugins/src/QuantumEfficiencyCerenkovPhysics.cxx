@@ -0,0 +1,114 @@
+//==========================================================================
+//  QuantumEfficiencyCerenkovPhysics
+//--------------------------------------------------------------------------
+//  Alternative to DD4hep's Geant4CerenkovPhysics that applies a photon
+//  detection efficiency at Cerenkov photon generation time. Registered as
+//  the DD4hep/Geant4 plugin "QuantumEfficiencyCerenkovPhysics".
+//
+//  In the selected logical volumes / regions the photon yield is scaled by
+//  the maximum efficiency and each photon is accepted with probability
+//  efficiency(lambda) / maximum, so photons that the
+//  OpticalPhotonEfficiencyStackingAction would kill are never created.
+//
+//  Configurable properties:
+//    MaxNumPhotonsPerStep, MaxBetaChangePerStep, TrackSecondariesFirst,
+//    StackPhotons, VerboseLevel (as for Geant4CerenkovPhysics), and
+//    LambdaMin, LambdaMax, Efficiency, LogicalVolume, Region (as for
+//    OpticalPhotonEfficiencyStackingAction).
+//==========================================================================
+
+// Framework include files
+#include <DDG4/Factories.h>
+#include <DDG4/Geant4PhysicsList.h>
+
+#include "npdet/QuantumEfficiencyCerenkov.h"
+
+// Geant4 include files
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4ProcessManager.hh"
+#include "G4Version.hh"
+
+// C/C++ include files
+#include <stdexcept>
+
+namespace npdet::sim {
+
+  using namespace dd4hep::sim;
+
+  /// Cerenkov physics constructor with the detection efficiency applied at generation
+  class QuantumEfficiencyCerenkovPhysics : public Geant4PhysicsList {
+  public:
+    QuantumEfficiencyCerenkovPhysics() = delete;
+    QuantumEfficiencyCerenkovPhysics(const QuantumEfficiencyCerenkovPhysics&) = delete;
+    QuantumEfficiencyCerenkovPhysics(Geant4Context* ctxt, const std::string& nam)
+      : Geant4PhysicsList(ctxt, nam) {
+      declareProperty("MaxNumPhotonsPerStep", m_maxNumPhotonsPerStep = 0);
+      declareProperty("MaxBetaChangePerStep", m_maxBetaChangePerStep = 0.0);
+      declareProperty("TrackSecondariesFirst", m_trackSecondariesFirst = false);
+      declareProperty("StackPhotons", m_stackPhotons = true);
+      declareProperty("VerboseLevel", m_verbosity = 0);
+      declareProperty("LambdaMin", m_lambdaMin = 0.0);
+      declareProperty("LambdaMax", m_lambdaMax = 0.0);
+      declareProperty("Efficiency", m_efficiency);
+      declareProperty("LogicalVolume", m_logicalVolume);
+      declareProperty("Region", m_region);
+    }
+    virtual ~QuantumEfficiencyCerenkovPhysics() = default;
+
+    /// Callback to construct processes (uses the G4 particle table)
+    virtual void constructProcesses(G4VUserPhysicsList* physics_list) override {
+      this->Geant4PhysicsList::constructProcesses(physics_list);
+      info("+++ Constructing: maxNumPhotonsPerStep:%d maxBeta:%f track secondaries:%s stack photons:%s",
+           m_maxNumPhotonsPerStep, m_maxBetaChangePerStep,
+           m_trackSecondariesFirst ? "YES" : "NO", m_stackPhotons ? "YES" : "NO");
+
+      QuantumEfficiencyCerenkov* process = nullptr;
+      try {
+        process = new QuantumEfficiencyCerenkov(name(), m_lambdaMin, m_lambdaMax, m_efficiency,
+                                                m_logicalVolume, m_region);
+      } catch (const std::invalid_argument& e) {
+        except("%s", e.what());
+      }
+      info("+++ Efficiency applied in lv regex '%s' or region regex '%s', maximum %f",
+           m_logicalVolume.c_str(), m_region.c_str(), process->maxEfficiency());
+      process->SetVerboseLevel(m_verbosity);
+      process->SetMaxNumPhotonsPerStep(m_maxNumPhotonsPerStep);
+      process->SetMaxBetaChangePerStep(m_maxBetaChangePerStep);
+      process->SetTrackSecondariesFirst(m_trackSecondariesFirst);
+#if G4VERSION_NUMBER >= 1070
+      process->SetStackPhotons(m_stackPhotons);
+#endif
+      auto pit = G4ParticleTable::GetParticleTable()->GetIterator();
+      pit->reset();
+      while ((*pit)()) {
+        G4ParticleDefinition* particle = pit->value();
+        if (process->IsApplicable(*particle)) {
+          G4ProcessManager* pmanager = particle->GetProcessManager();
+          pmanager->AddProcess(process);
+          pmanager->SetProcessOrdering(process, idxPostStep);
+          debug("+++ Cerenkov: Set Process ordering for particle: %s", particle->GetParticleName().c_str());
+        }
+      }
+    }
+
+  private:
+    double              m_maxBetaChangePerStep;
+    int                 m_maxNumPhotonsPerStep;
+    int                 m_verbosity;
+    bool                m_trackSecondariesFirst;
+    bool                m_stackPhotons;
+    double              m_lambdaMin;
+    double              m_lambdaMax;
+    std::vector<double> m_efficiency;
+    std::string         m_logicalVolume;
+    std::string         m_region;
+  };
+
+} // namespace npdet::sim
+
+namespace dd4hep::sim {
+  using QuantumEfficiencyCerenkovPhysics = npdet::sim::QuantumEfficiencyCerenkovPhysics;
+}
+
+DECLARE_GEANT4ACTION(QuantumEfficiencyCerenkovPhysics)
@@ -0,0 +1,147 @@
+#include "npdet/RegionCutTable.h"
+
+// Framework include files
+#include <DD4hep/Handle.h>
+
+// C/C++ include files
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace npdet::sim {
+
+  /// True if the region applies to particles of this PDG code
+  bool RegionCutTable::Region::appliesTo(int pdg_code) const {
+    return pdg.empty() || std::binary_search(pdg.begin(), pdg.end(), pdg_code);
+  }
+
+  /// Parse a region specification
+  RegionCutTable::Region RegionCutTable::parse(const std::string& spec) {
+    Region      region;
+    const auto  colon = spec.find(':');
+    if (colon == std::string::npos) {
+      throw std::invalid_argument("Region cut '" + spec + "' has no 'name:' prefix");
+    }
+    std::istringstream name_stream(spec.substr(0, colon));
+    name_stream >> region.name;
+    if (region.name.empty()) {
+      throw std::invalid_argument("Region cut '" + spec + "' has an empty name");
+    }
+
+    std::istringstream tokens(spec.substr(colon + 1));
+    std::string        token;
+    while (tokens >> token) {
+      const auto eq = token.find('=');
+      if (eq == std::string::npos || eq == 0 || eq + 1 == token.size()) {
+        throw std::invalid_argument("Region cut '" + region.name + "': expected key=value, got '" + token + "'");
+      }
+      const std::string key   = token.substr(0, eq);
+      const std::string value = token.substr(eq + 1);
+      if (key == "zmin") {
+        region.zmin = dd4hep::_toDouble(value);
+      } else if (key == "zmax") {
+        region.zmax = dd4hep::_toDouble(value);
+      } else if (key == "rmin") {
+        region.rmin = dd4hep::_toDouble(value);
+      } else if (key == "rmax") {
+        region.rmax = dd4hep::_toDouble(value);
+      } else if (key == "pmin") {
+        region.momentumMin = dd4hep::_toDouble(value);
+      } else if (key == "ekinmin") {
+        region.energyMin = dd4hep::_toDouble(value);
+      } else if (key == "pdg") {
+        std::istringstream codes(value);
+        std::string        code;
+        while (std::getline(codes, code, ',')) {
+          region.pdg.push_back(std::stoi(code));
+        }
+      } else {
+        throw std::invalid_argument("Region cut '" + region.name + "': unknown key '" + key + "'");
+      }
+    }
+    if (!(region.zmin < region.zmax) || !(region.rmin < region.rmax) || region.rmin < 0.) {
+      throw std::invalid_argument("Region cut '" + region.name + "' has an empty (r,z) range");
+    }
+    std::sort(region.pdg.begin(), region.pdg.end());
+    return region;
+  }
+
+  /// Append a region; invalidates the index
+  void RegionCutTable::add(Region region) {
+    if (m_regions.size() >= std::numeric_limits<std::uint16_t>::max()) {
+      throw std::length_error("Too many region cuts");
+    }
+    m_regions.push_back(std::move(region));
+    m_zEdges.clear();
+    m_rEdges.clear();
+    m_cellBegin.clear();
+    m_cellRegions.clear();
+  }
+
+  /// Remove all regions
+  void RegionCutTable::clear() {
+    m_regions.clear();
+    m_zEdges.clear();
+    m_rEdges.clear();
+    m_cellBegin.clear();
+    m_cellRegions.clear();
+  }
+
+  /// Build the (r,z) index
+  void RegionCutTable::compile() {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    m_zEdges = {-inf, inf};
+    m_rEdges = {0., inf};
+    for (const auto& region : m_regions) {
+      m_zEdges.insert(m_zEdges.end(), {region.zmin, region.zmax});
+      m_rEdges.insert(m_rEdges.end(), {region.rmin, region.rmax});
+    }
+    for (auto* edges : {&m_zEdges, &m_rEdges}) {
+      std::sort(edges->begin(), edges->end());
+      edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+    }
+
+    // Every region boundary is a grid edge, so a region either covers a cell
+    // completely or not at all.
+    const std::size_t nz = m_zEdges.size() - 1;
+    const std::size_t nr = m_rEdges.size() - 1;
+    m_cellBegin.assign(1, 0);
+    m_cellBegin.reserve(nz * nr + 1);
+    m_cellRegions.clear();
+    for (std::size_t iz = 0; iz < nz; ++iz) {
+      for (std::size_t ir = 0; ir < nr; ++ir) {
+        for (std::size_t i = 0; i < m_regions.size(); ++i) {
+          const auto& region = m_regions[i];
+          if (region.zmin <= m_zEdges[iz] && m_zEdges[iz + 1] <= region.zmax &&
+              region.rmin <= m_rEdges[ir] && m_rEdges[ir + 1] <= region.rmax) {
+            m_cellRegions.push_back(static_cast<std::uint16_t>(i));
+          }
+        }
+        m_cellBegin.push_back(static_cast<std::uint32_t>(m_cellRegions.size()));
+      }
+    }
+  }
+
+  /// First region applicable to a particle of this PDG code ending at (r,z), or nullptr
+  const RegionCutTable::Region* RegionCutTable::find(double r, double z, int pdg_code) const {
+    if (m_cellBegin.empty()) {
+      return nullptr;
+    }
+    const auto iz = std::upper_bound(m_zEdges.begin(), m_zEdges.end(), z) - m_zEdges.begin() - 1;
+    const auto ir = std::upper_bound(m_rEdges.begin(), m_rEdges.end(), r) - m_rEdges.begin() - 1;
+    const auto nz = static_cast<std::ptrdiff_t>(m_zEdges.size()) - 1;
+    const auto nr = static_cast<std::ptrdiff_t>(m_rEdges.size()) - 1;
+    if (iz < 0 || iz >= nz || ir < 0 || ir >= nr) {
+      return nullptr;
+    }
+    const auto cell = static_cast<std::size_t>(iz * nr + ir);
+    for (auto k = m_cellBegin[cell]; k < m_cellBegin[cell + 1]; ++k) {
+      const auto& region = m_regions[m_cellRegions[k]];
+      if (region.appliesTo(pdg_code)) {
+        return &region;
+      }
+    }
+    return nullptr;
+  }
+
+} // namespace npdet::sim
@@ -0,0 +1,101 @@
+#include "npdet/TrackingVolumeClassifier.h"
+
+// ROOT include files
+#include "TGeoBBox.h"
+#include "TGeoShape.h"
+
+// C/C++ include files
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace npdet::sim {
+
+  /// Build the grid for a shape, using at most max_cells cells
+  TrackingVolumeClassifier::TrackingVolumeClassifier(const TGeoShape* shape, std::size_t max_cells)
+    : m_shape(shape) {
+    // Every TGeo shape derives from TGeoBBox and carries its bounding box
+    const auto* box = dynamic_cast<const TGeoBBox*>(shape);
+    if (box == nullptr || max_cells == 0) {
+      return;
+    }
+    const double* origin = box->GetOrigin();
+    const std::array<double, 3> half = {box->GetDX(), box->GetDY(), box->GetDZ()};
+    if (half[0] <= 0. || half[1] <= 0. || half[2] <= 0.) {
+      return;
+    }
+
+    // Roughly cubic cells such that the total count stays below max_cells
+    const double step = std::cbrt(8. * half[0] * half[1] * half[2] / static_cast<double>(max_cells));
+    std::array<double, 3> cell{};
+    for (int i = 0; i < 3; ++i) {
+      m_n[i]       = std::max(1, static_cast<int>(std::floor(2. * half[i] / step)));
+      cell[i]      = 2. * half[i] / m_n[i];
+      m_lo[i]      = origin[i] - half[i];
+      m_invStep[i] = 1. / cell[i];
+    }
+    const double half_diagonal = 0.5 * std::sqrt(cell[0] * cell[0] + cell[1] * cell[1] + cell[2] * cell[2]);
+
+    m_cells.resize(static_cast<std::size_t>(m_n[0]) * m_n[1] * m_n[2]);
+    std::size_t idx = 0;
+    for (int iz = 0; iz < m_n[2]; ++iz) {
+      for (int iy = 0; iy < m_n[1]; ++iy) {
+        for (int ix = 0; ix < m_n[0]; ++ix, ++idx) {
+          const double center[3] = {m_lo[0] + (ix + 0.5) * cell[0],
+                                    m_lo[1] + (iy + 0.5) * cell[1],
+                                    m_lo[2] + (iz + 0.5) * cell[2]};
+          const bool inside = m_shape->Contains(center);
+          // Safety is a lower bound on the distance to the surface: if it exceeds
+          // the half diagonal, the whole cell is on the same side as its center.
+          const double safety = m_shape->Safety(center, inside);
+          if (safety > half_diagonal) {
+            m_cells[idx] = inside ? INSIDE : OUTSIDE;
+          } else {
+            m_cells[idx] = BOUNDARY;
+          }
+        }
+      }
+    }
+  }
+
+  /// Exact TGeo shape test
+  bool TrackingVolumeClassifier::containsExact(const double* point) const {
+    return m_shape->Contains(point);
+  }
+
+  /// Fraction of grid cells that require the exact shape test
+  double TrackingVolumeClassifier::boundaryFraction() const {
+    if (m_cells.empty()) {
+      return 1.;
+    }
+    return static_cast<double>(std::count(m_cells.begin(), m_cells.end(), BOUNDARY)) / m_cells.size();
+  }
+
+  /// Grid cell size along each axis
+  std::array<double, 3> TrackingVolumeClassifier::cellSize() const {
+    std::array<double, 3> cell{};
+    for (int i = 0; i < 3; ++i) {
+      cell[i] = m_invStep[i] > 0. ? 1. / m_invStep[i] : 0.;
+    }
+    return cell;
+  }
+
+  /// Classifier for this shape and cell limit, shared by all callers that hold it
+  std::shared_ptr<const TrackingVolumeClassifier> TrackingVolumeClassifier::shared(const TGeoShape* shape,
+                                                                                   std::size_t max_cells) {
+    using Key = std::pair<const TGeoShape*, std::size_t>;
+    static std::mutex                                                    s_lock;
+    static std::map<Key, std::weak_ptr<const TrackingVolumeClassifier>> s_cache;
+    std::lock_guard<std::mutex> guard(s_lock);
+    auto& cached = s_cache[Key(shape, max_cells)];
+    if (auto classifier = cached.lock()) {
+      return classifier;
+    }
+    auto classifier = std::make_shared<const TrackingVolumeClassifier>(shape, max_cells);
+    cached          = classifier;
+    return classifier;
+  }
+
+} // namespace npdet::sim
@@ -0,0 +1,152 @@
+#include "npdet/VertexDistribution.h"
+
+// C/C++ include files
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+// POSIX include files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace npdet::sim {
+
+namespace {
+
+  constexpr char          s_magic[8] = "NPVTX4D";
+  constexpr std::uint32_t s_version  = 1;
+
+  struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t nbins[4];
+    std::uint32_t reserved;
+    double        lo[4];
+    double        hi[4];
+  };
+  static_assert(sizeof(Header) == 96, "unexpected header padding");
+
+  /// Read-only mapping of a whole file, unmapped on destruction
+  class MappedFile {
+  public:
+    explicit MappedFile(const std::string& path) {
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("VertexDistribution: cannot open " + path + ": " + std::strerror(errno));
+      }
+      struct stat st;
+      if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("VertexDistribution: cannot read " + path);
+      }
+      m_size = st.st_size;
+      m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (m_data == MAP_FAILED) {
+        throw std::runtime_error("VertexDistribution: cannot map " + path + ": " + std::strerror(errno));
+      }
+    }
+    ~MappedFile() { ::munmap(m_data, m_size); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(m_data); }
+    std::size_t size() const { return m_size; }
+
+  private:
+    void*       m_data = nullptr;
+    std::size_t m_size = 0;
+  };
+
+} // namespace
+
+/// Load and build from a file; throws std::runtime_error on any format error
+VertexDistribution::VertexDistribution(const std::string& path) {
+  MappedFile file(path);
+  Header     header;
+  if (file.size() < sizeof(Header)) {
+    throw std::runtime_error("VertexDistribution: " + path + " is too short for the header");
+  }
+  std::memcpy(&header, file.data(), sizeof(Header));
+  if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0) {
+    throw std::runtime_error("VertexDistribution: " + path + " is not a vertex distribution file");
+  }
+  if (header.version != s_version) {
+    throw std::runtime_error("VertexDistribution: " + path + " has unsupported version " +
+                             std::to_string(header.version));
+  }
+  std::size_t n = 1;
+  for (int d = 0; d < 4; ++d) {
+    if (header.nbins[d] == 0 || !(header.hi[d] > header.lo[d])) {
+      throw std::runtime_error("VertexDistribution: " + path + " has an empty axis " + std::to_string(d));
+    }
+    m_bins[d]  = header.nbins[d];
+    m_lo[d]    = header.lo[d];
+    m_width[d] = (header.hi[d] - header.lo[d]) / header.nbins[d];
+    n *= header.nbins[d];
+  }
+  if (n > UINT32_MAX || file.size() != sizeof(Header) + n * sizeof(double)) {
+    throw std::runtime_error("VertexDistribution: " + path + " size does not match its " + std::to_string(n) +
+                             " bins");
+  }
+
+  // The mapping is page aligned and the header is 96 bytes, so the weights are aligned doubles
+  const auto* weights = reinterpret_cast<const double*>(file.data() + sizeof(Header));
+  std::vector<double> scaled(n);
+  double total = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double w = weights[i];
+    if (!(w >= 0) || !std::isfinite(w)) {
+      throw std::runtime_error("VertexDistribution: " + path + " has an invalid weight in bin " + std::to_string(i));
+    }
+    scaled[i] = w;
+    total += w;
+  }
+  if (!(total > 0)) {
+    throw std::runtime_error("VertexDistribution: " + path + " has no positive weight");
+  }
+
+  // Vose's alias method: bins below the mean are topped up by one bin above it
+  m_probability.assign(n, 1.0f);
+  m_alias.resize(n);
+  std::vector<std::uint32_t> small, large;
+  for (std::size_t i = 0; i < n; ++i) {
+    scaled[i] *= n / total;
+    m_alias[i] = i;
+    (scaled[i] < 1.0 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    const std::uint32_t s = small.back();
+    const std::uint32_t l = large.back();
+    small.pop_back();
+    m_probability[s] = scaled[s];
+    m_alias[s]       = l;
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Whatever is left is 1 up to rounding
+}
+
+/// Table for this file, shared by all callers that hold it
+std::shared_ptr<const VertexDistribution> VertexDistribution::shared(const std::string& path) {
+  static std::mutex                                                      s_lock;
+  static std::map<std::string, std::weak_ptr<const VertexDistribution>> s_cache;
+  std::lock_guard<std::mutex> guard(s_lock);
+  auto& cached = s_cache[path];
+  if (auto table = cached.lock()) {
+    return table;
+  }
+  auto table = std::make_shared<const VertexDistribution>(path);
+  cached     = table;
+  return table;
+}
+
+} // namespace npdet::sim
@@ -0,0 +1,166 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "npdet/HepMC3EventIndex.h"
+
+// C/C++ include files
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// POSIX include files
+#include <utime.h>
+
+using npdet::sim::HepMC3EventIndex;
+
+namespace {
+
+  std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("npdet_index_" + name + ".hepmc3")).string();
+  }
+
+  void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+  }
+
+  /// Small HepMC3 file; offsets receives the position of every event record
+  std::string events(int n, std::vector<std::uint64_t>& offsets) {
+    std::string text = "HepMC::Version 3.02.02\nHepMC::Asciiv3-START_EVENT_LISTING\n";
+    text += "W weight\nT generator 1.0 \"Events\"\n";
+    for (int i = 0; i < n; ++i) {
+      offsets.push_back(text.size());
+      std::ostringstream e;
+      e << "E " << i << " 1 3\nU GEV MM\nA 0 tag E\nP 1 0 2212 0 0 1 1 0.9 4\nP 2 0 11 0 0 -1 1 0 4\n"
+        << "V -1 0 [1,2]\nP 3 -1 11 0 0 " << i << " 1 0 1\n";
+      text += e.str();
+    }
+    return text + "HepMC::Asciiv3-END_EVENT_LISTING\n";
+  }
+
+  /// Index of the file as npdet_hepmc3_index writes it
+  HepMC3EventIndex indexFile(const std::string& file, const std::string& text) {
+    HepMC3EventIndex index = HepMC3EventIndex::build(text.data(), text.size());
+    std::uint64_t    size  = 0;
+    REQUIRE(HepMC3EventIndex::file_status(file, size, index.file_mtime));
+    REQUIRE(size == index.file_size);
+    REQUIRE(index.write(HepMC3EventIndex::path(file)));
+    return index;
+  }
+
+  void removeFiles(const std::string& file) {
+    std::filesystem::remove(file);
+    std::filesystem::remove(HepMC3EventIndex::path(file));
+  }
+
+} // namespace
+
+TEST_CASE("Offsets point at the event records", "[hepmc3_index]") {
+  std::vector<std::uint64_t> expected;
+  const std::string          text  = events(25, expected);
+  const HepMC3EventIndex     index = HepMC3EventIndex::build(text.data(), text.size());
+  CHECK(index.file_size == text.size());
+  CHECK(index.offsets == expected);
+  for (auto offset : index.offsets) {
+    CHECK(text.compare(offset, 2, "E ") == 0);
+  }
+
+  SECTION("a record at the start of the data") {
+    const std::string      record = "E 0 0 0\nE 1 0 0\n";
+    const HepMC3EventIndex bare   = HepMC3EventIndex::build(record.data(), record.size());
+    CHECK(bare.offsets == std::vector<std::uint64_t>{0, 8});
+  }
+  SECTION("no events") {
+    std::vector<std::uint64_t> none;
+    const std::string          empty = events(0, none);
+    CHECK(HepMC3EventIndex::build(empty.data(), empty.size()).offsets.empty());
+  }
+}
+
+TEST_CASE("Index round trips through its sidecar file", "[hepmc3_index]") {
+  const std::string          file = tempPath("roundtrip");
+  std::vector<std::uint64_t> expected;
+  const std::string          text = events(40, expected);
+  writeFile(file, text);
+  const HepMC3EventIndex written = indexFile(file, text);
+
+  HepMC3EventIndex loaded;
+  REQUIRE(HepMC3EventIndex::load(file, loaded));
+  CHECK(loaded.file_size == written.file_size);
+  CHECK(loaded.file_mtime == written.file_mtime);
+  CHECK(loaded.offsets == expected);
+  removeFiles(file);
+}
+
+TEST_CASE("Stale or invalid indices are not used", "[hepmc3_index]") {
+  const std::string          file = tempPath("stale");
+  std::vector<std::uint64_t> expected;
+  const std::string          text = events(10, expected);
+  HepMC3EventIndex           loaded;
+
+  SECTION("no index") {
+    writeFile(file, text);
+    std::filesystem::remove(HepMC3EventIndex::path(file));
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("no file") {
+    writeFile(file, text);
+    indexFile(file, text);
+    std::filesystem::remove(file);
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("file grew") {
+    writeFile(file, text);
+    indexFile(file, text);
+    writeFile(file, text + "E 10 0 0\n");
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("file modified with the same size") {
+    writeFile(file, text);
+    const HepMC3EventIndex index = indexFile(file, text);
+    struct ::utimbuf       times;
+    times.actime  = index.file_mtime + 10;
+    times.modtime = index.file_mtime + 10;
+    REQUIRE(::utime(file.c_str(), &times) == 0);
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("wrong magic") {
+    writeFile(file, text);
+    indexFile(file, text);
+    std::fstream idx(HepMC3EventIndex::path(file), std::ios::binary | std::ios::in | std::ios::out);
+    idx.write("NPHMC2IX", 8);
+    idx.close();
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("wrong version") {
+    writeFile(file, text);
+    indexFile(file, text);
+    std::fstream        idx(HepMC3EventIndex::path(file), std::ios::binary | std::ios::in | std::ios::out);
+    const std::uint32_t version = HepMC3EventIndex::version + 1;
+    idx.seekp(8);
+    idx.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    idx.close();
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("truncated offsets") {
+    writeFile(file, text);
+    indexFile(file, text);
+    const auto idx = HepMC3EventIndex::path(file);
+    std::filesystem::resize_file(idx, std::filesystem::file_size(idx) - sizeof(std::uint64_t));
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  SECTION("more events than bytes") {
+    writeFile(file, text);
+    indexFile(file, text);
+    std::fstream        idx(HepMC3EventIndex::path(file), std::ios::binary | std::ios::in | std::ios::out);
+    const std::uint64_t n = text.size() + 1;
+    idx.seekp(32);
+    idx.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    idx.close();
+    CHECK_FALSE(HepMC3EventIndex::load(file, loaded));
+  }
+  removeFiles(file);
+}
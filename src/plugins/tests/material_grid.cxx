@@ -0,0 +1,172 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "npdet/MaterialGrid.h"
+
+// C/C++ include files
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using npdet::mat::MaterialGrid;
+using npdet::mat::MaterialGridHeader;
+
+namespace {
+
+  std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("npdet_grid_" + name + ".npgrid")).string();
+  }
+
+  /// Grid with unequal bins and ranges on every axis and random voxel contents
+  struct TestGrid {
+    MaterialGridHeader header;
+    std::vector<float> inv_x0, inv_lambda;
+
+    TestGrid() {
+      header.nbins[0] = 7;
+      header.nbins[1] = 11;
+      header.nbins[2] = 13;
+      header.samples  = 1;
+      for (int a = 0; a < 3; ++a) {
+        header.lo[a] = -10. - a;
+        header.hi[a] = 12. + 3. * a;
+      }
+      std::mt19937_64                       rng(7);
+      std::uniform_real_distribution<float> u(0.f, 1.f);
+      for (std::size_t i = 0; i < header.size(); ++i) {
+        // Some empty voxels, as in the gaps between detectors
+        inv_x0.push_back(i % 4 == 0 ? 0.f : u(rng));
+        inv_lambda.push_back(0.1f * u(rng));
+      }
+    }
+
+    std::string write(const std::string& name) const {
+      const std::string path = tempPath(name);
+      REQUIRE(MaterialGrid::write(path, header, inv_x0.data(), inv_lambda.data()));
+      return path;
+    }
+
+    /// Integral by fine stepping along the line, sampling the voxel at the middle of each step
+    MaterialGrid::Budget stepped(const double p0[3], const double p1[3], int steps) const {
+      MaterialGrid::Budget budget;
+      const double         d[3]   = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      const double         length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+      for (int s = 0; s < steps; ++s) {
+        const double t = (s + 0.5) / steps;
+        std::size_t  index[3];
+        bool         inside = true;
+        for (int a = 0; a < 3; ++a) {
+          const double x = p0[a] + t * d[a];
+          if (x < header.lo[a] || x >= header.hi[a]) {
+            inside = false;
+            break;
+          }
+          index[a] = std::size_t((x - header.lo[a]) / (header.hi[a] - header.lo[a]) * header.nbins[a]);
+        }
+        if (!inside) continue;
+        const std::size_t i = (index[0] * header.nbins[1] + index[1]) * header.nbins[2] + index[2];
+        budget.x0 += inv_x0[i] * length / steps;
+        budget.lambda += inv_lambda[i] * length / steps;
+        budget.length += length / steps;
+      }
+      return budget;
+    }
+  };
+
+} // namespace
+
+TEST_CASE("Voxel traversal matches fine stepping", "[material_grid]") {
+  const TestGrid     grid;
+  const std::string  path = grid.write("stepping");
+  const MaterialGrid map(path);
+
+  std::mt19937_64                        rng(11);
+  std::uniform_real_distribution<double> u(-25., 30.);
+  const int                              steps = 20000;
+  for (int i = 0; i < 200; ++i) {
+    const double p0[3] = {u(rng), u(rng), u(rng)};
+    const double p1[3] = {u(rng), u(rng), u(rng)};
+    const auto   exact = map.integrate(p0, p1);
+    const auto   fine  = grid.stepped(p0, p1, steps);
+    // Each voxel boundary crossed costs the stepped sum at most one step
+    const double line  = std::sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1]) +
+                                   (p1[2] - p0[2]) * (p1[2] - p0[2]));
+    const double tol   = 40. * line / steps;
+    INFO("ray " << i);
+    CHECK(exact.length == Approx(fine.length).margin(tol));
+    CHECK(exact.x0 == Approx(fine.x0).margin(tol));
+    CHECK(exact.lambda == Approx(fine.lambda).margin(tol));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Simple lines through the grid", "[material_grid]") {
+  TestGrid grid;
+  // 1/X0 = ix + 1, 1/lambda = 1 everywhere
+  for (std::size_t ix = 0; ix < grid.header.nbins[0]; ++ix) {
+    for (std::size_t j = 0; j < std::size_t(grid.header.nbins[1]) * grid.header.nbins[2]; ++j) {
+      grid.inv_x0[ix * grid.header.nbins[1] * grid.header.nbins[2] + j] = ix + 1;
+    }
+  }
+  std::fill(grid.inv_lambda.begin(), grid.inv_lambda.end(), 1.f);
+  const std::string  path = grid.write("lines");
+  const MaterialGrid map(path);
+  const double       width = (grid.header.hi[0] - grid.header.lo[0]) / grid.header.nbins[0];
+
+  SECTION("across the whole grid along x") {
+    const double p0[3] = {-50., 0.3, 0.7}, p1[3] = {50., 0.3, 0.7};
+    const auto   budget = map.integrate(p0, p1);
+    CHECK(budget.length == Approx(grid.header.hi[0] - grid.header.lo[0]));
+    CHECK(budget.lambda == Approx(budget.length));
+    CHECK(budget.x0 == Approx(width * 7 * 8 / 2));
+  }
+  SECTION("direction does not matter") {
+    const double p0[3] = {-30., -8., 20.}, p1[3] = {25., 14., -9.};
+    const auto   forward  = map.integrate(p0, p1);
+    const auto   backward = map.integrate(p1, p0);
+    CHECK(forward.x0 == Approx(backward.x0));
+    CHECK(forward.lambda == Approx(backward.lambda));
+    CHECK(forward.length == Approx(backward.length));
+  }
+  SECTION("segment inside one voxel") {
+    const double p0[3] = {-9.9, 0.1, 0.1}, p1[3] = {-9.5, 0.2, 0.2};
+    const auto   budget = map.integrate(p0, p1);
+    CHECK(budget.length == Approx(std::sqrt(0.16 + 0.01 + 0.01)));
+    CHECK(budget.x0 == Approx(budget.length));
+  }
+  SECTION("lines missing the grid") {
+    const double above[3] = {0., 0., 50.}, beyond[3] = {100., 0., 50.};
+    CHECK(map.integrate(above, beyond).length == 0);
+    const double point[3] = {1., 1., 1.};
+    CHECK(map.integrate(point, point).length == 0);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Grid files are validated", "[material_grid]") {
+  const TestGrid     grid;
+  const std::string  path = grid.write("header");
+  MaterialGridHeader header;
+  REQUIRE(MaterialGrid::read_header(path, header));
+  CHECK(header.same_grid(grid.header));
+
+  // Data does not match the header
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(float));
+  CHECK_THROWS_AS(MaterialGrid(path), std::runtime_error);
+
+  // Not a grid file
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << std::string(200, 'x');
+  }
+  CHECK_FALSE(MaterialGrid::read_header(path, header));
+  CHECK_THROWS_AS(MaterialGrid(path), std::runtime_error);
+
+  std::filesystem::remove(path);
+  CHECK_FALSE(MaterialGrid::read_header(path, header));
+  CHECK_THROWS_AS(MaterialGrid(path), std::runtime_error);
+}
@@ -0,0 +1,126 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "npdet/RegionCutTable.h"
+
+// Framework include files
+#include "DD4hep/DD4hepUnits.h"
+
+// C/C++ include files
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using npdet::sim::RegionCutTable;
+
+TEST_CASE("Region specifications are parsed in DD4hep units", "[region_cuts]") {
+  const auto region =
+      RegionCutTable::parse("forward: zmin=590*cm zmax=680*cm rmin=2*cm rmax=30*cm pmin=50*MeV ekinmin=10*MeV pdg=2112,22");
+  CHECK(region.name == "forward");
+  CHECK(region.zmin == Approx(590 * dd4hep::cm));
+  CHECK(region.zmax == Approx(680 * dd4hep::cm));
+  CHECK(region.rmin == Approx(2 * dd4hep::cm));
+  CHECK(region.rmax == Approx(30 * dd4hep::cm));
+  CHECK(region.momentumMin == Approx(50 * dd4hep::MeV));
+  CHECK(region.energyMin == Approx(10 * dd4hep::MeV));
+  CHECK(region.pdg == std::vector<int>{22, 2112});
+  CHECK(region.appliesTo(22));
+  CHECK_FALSE(region.appliesTo(11));
+}
+
+TEST_CASE("Omitted keys leave the region unbounded", "[region_cuts]") {
+  const auto region = RegionCutTable::parse("  all  : pmin=1*GeV");
+  CHECK(region.name == "all");
+  CHECK(std::isinf(region.zmin));
+  CHECK(region.zmin < 0);
+  CHECK(std::isinf(region.zmax));
+  CHECK(region.rmin == 0);
+  CHECK(std::isinf(region.rmax));
+  CHECK(region.momentumMin == Approx(1 * dd4hep::GeV));
+  CHECK(region.energyMin == 0);
+  CHECK(region.appliesTo(11));
+}
+
+TEST_CASE("Malformed region specifications are rejected", "[region_cuts]") {
+  CHECK_THROWS_AS(RegionCutTable::parse("zmin=1*cm"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse(": zmin=1*cm"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: zmin"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: =1*cm"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: zmin="), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: phimin=1"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: zmin=2*cm zmax=1*cm"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: rmin=3*cm rmax=3*cm"), std::invalid_argument);
+  CHECK_THROWS_AS(RegionCutTable::parse("r: rmin=-1*cm"), std::invalid_argument);
+}
+
+TEST_CASE("The first matching region wins", "[region_cuts]") {
+  RegionCutTable table;
+  table.add(RegionCutTable::parse("photons: zmin=0 zmax=10 rmax=5 pdg=22"));
+  table.add(RegionCutTable::parse("inner: zmin=0 zmax=10 rmax=5"));
+  table.add(RegionCutTable::parse("outer: zmin=-20 zmax=20 rmax=50"));
+
+  // Lookups before compile() find nothing
+  CHECK(table.find(1, 1, 22) == nullptr);
+  table.compile();
+
+  CHECK(table.find(1, 1, 22)->name == "photons");
+  CHECK(table.find(1, 1, 11)->name == "inner");
+  CHECK(table.find(6, 1, 22)->name == "outer");
+  CHECK(table.find(1, -1, 22)->name == "outer");
+  // Ranges include the lower and exclude the upper boundary
+  CHECK(table.find(0, 0, 11)->name == "inner");
+  CHECK(table.find(5, 0, 11)->name == "outer");
+  CHECK(table.find(1, 10, 11)->name == "outer");
+  CHECK(table.find(50, 0, 11) == nullptr);
+  CHECK(table.find(1, 20, 11) == nullptr);
+  CHECK(table.find(1, -21, 11) == nullptr);
+
+  // Adding a region invalidates the index
+  table.add(RegionCutTable::parse("far: zmin=20 zmax=30"));
+  CHECK(table.find(1, 1, 11) == nullptr);
+  table.compile();
+  CHECK(table.find(100, 25, 11)->name == "far");
+}
+
+TEST_CASE("Indexed lookup matches a linear scan of the regions", "[region_cuts]") {
+  std::mt19937_64                        rng(2024);
+  std::uniform_real_distribution<double> edge(-100., 100.);
+  std::uniform_int_distribution<int>     species(0, 2);
+  const int                              codes[3] = {11, 22, 2112};
+
+  RegionCutTable table;
+  for (int i = 0; i < 40; ++i) {
+    RegionCutTable::Region region;
+    region.name = "region" + std::to_string(i);
+    region.zmin = edge(rng);
+    region.zmax = region.zmin + std::abs(edge(rng)) + 1;
+    region.rmin = std::abs(edge(rng)) / 2;
+    region.rmax = region.rmin + std::abs(edge(rng)) + 1;
+    if (i % 3 == 0) {
+      region.pdg = {codes[species(rng)]};
+    }
+    table.add(region);
+  }
+  table.compile();
+
+  auto linear = [&](double r, double z, int pdg) -> const RegionCutTable::Region* {
+    for (const auto& region : table.regions()) {
+      if (region.zmin <= z && z < region.zmax && region.rmin <= r && r < region.rmax && region.appliesTo(pdg)) {
+        return &region;
+      }
+    }
+    return nullptr;
+  };
+  std::uniform_real_distribution<double> z(-250., 250.);
+  std::uniform_real_distribution<double> r(0., 250.);
+  int wrong = 0;
+  for (int i = 0; i < 100000; ++i) {
+    const double rr = r(rng), zz = z(rng);
+    const int    pdg = codes[species(rng)];
+    if (table.find(rr, zz, pdg) != linear(rr, zz, pdg)) {
+      ++wrong;
+    }
+  }
+  REQUIRE(wrong == 0);
+}
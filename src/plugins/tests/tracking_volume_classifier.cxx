@@ -0,0 +1,93 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "npdet/TrackingVolumeClassifier.h"
+
+// ROOT include files
+#include "TGeoPcon.h"
+#include "TGeoTube.h"
+
+// C/C++ include files
+#include <cstddef>
+#include <random>
+
+using npdet::sim::TrackingVolumeClassifier;
+
+namespace {
+
+  /// Number of random points in the bounding box, enlarged by 10%, where classifier and shape disagree
+  std::size_t disagreements(const TrackingVolumeClassifier& classifier, const TGeoBBox& shape, std::size_t n) {
+    std::mt19937_64                        rng(12345);
+    std::uniform_real_distribution<double> u(-1.1, 1.1);
+    const double*                          origin = shape.GetOrigin();
+    std::size_t                            wrong  = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double point[3] = {origin[0] + u(rng) * shape.GetDX(), origin[1] + u(rng) * shape.GetDY(),
+                               origin[2] + u(rng) * shape.GetDZ()};
+      if (classifier.contains(point) != shape.Contains(point)) {
+        ++wrong;
+      }
+    }
+    return wrong;
+  }
+
+} // namespace
+
+TEST_CASE("Classifier agrees with the exact shape test", "[classifier]") {
+  SECTION("tube") {
+    TGeoTube                       tube(0., 80., 120.);
+    const TrackingVolumeClassifier classifier(&tube, 1 << 16);
+    REQUIRE(classifier.size() > 0);
+    REQUIRE(classifier.boundaryFraction() < 1.);
+    REQUIRE(disagreements(classifier, tube, 200000) == 0);
+  }
+  SECTION("polycone") {
+    // Narrower at the ends, like the tracking volume
+    TGeoPcon pcon(0., 360., 4);
+    pcon.DefineSection(0, -180., 0., 40.);
+    pcon.DefineSection(1, -100., 0., 80.);
+    pcon.DefineSection(2, 120., 0., 80.);
+    pcon.DefineSection(3, 200., 0., 30.);
+    const TrackingVolumeClassifier classifier(&pcon, 1 << 16);
+    REQUIRE(classifier.size() > 0);
+    REQUIRE(disagreements(classifier, pcon, 200000) == 0);
+  }
+}
+
+TEST_CASE("Grid stays within the cell budget", "[classifier]") {
+  TGeoTube tube(0., 80., 120.);
+  for (std::size_t max_cells : {1, 7, 1000, 1 << 20}) {
+    const TrackingVolumeClassifier classifier(&tube, max_cells);
+    CHECK(classifier.size() >= 1);
+    CHECK(classifier.size() <= max_cells);
+  }
+}
+
+TEST_CASE("Points outside the bounding box are outside", "[classifier]") {
+  TGeoTube                       tube(0., 80., 120.);
+  const TrackingVolumeClassifier classifier(&tube, 1000);
+  const double                   beyond_z[3] = {0., 0., 121.};
+  const double                   beyond_x[3] = {-81., 0., 0.};
+  const double                   center[3]   = {0., 0., 0.};
+  CHECK_FALSE(classifier.contains(beyond_z));
+  CHECK_FALSE(classifier.contains(beyond_x));
+  CHECK(classifier.contains(center));
+}
+
+TEST_CASE("Empty classifier uses the exact shape test", "[classifier]") {
+  TGeoTube                       tube(0., 80., 120.);
+  const TrackingVolumeClassifier classifier(&tube, 0);
+  REQUIRE(classifier.size() == 0);
+  REQUIRE(classifier.boundaryFraction() == 1.);
+  REQUIRE(disagreements(classifier, tube, 10000) == 0);
+}
+
+TEST_CASE("Shared classifiers are built once per shape and cell limit", "[classifier]") {
+  TGeoTube   tube(0., 80., 120.);
+  const auto first  = TrackingVolumeClassifier::shared(&tube, 1000);
+  const auto second = TrackingVolumeClassifier::shared(&tube, 1000);
+  const auto finer  = TrackingVolumeClassifier::shared(&tube, 8000);
+  CHECK(first == second);
+  CHECK(first != finer);
+  CHECK(finer->size() > first->size());
+}
@@ -0,0 +1,165 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "npdet/VertexDistribution.h"
+
+// C/C++ include files
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using npdet::sim::VertexDistribution;
+
+namespace {
+
+  /// Distribution file in the format documented in VertexDistribution.h
+  struct TestFile {
+    std::array<std::uint32_t, 4> nbins{3, 2, 4, 2};
+    std::array<double, 4>        lo{-1., -0.5, -100., -0.2};
+    std::array<double, 4>        hi{1., 0.5, 100., 0.2};
+    std::vector<double>          weights;
+    std::uint32_t                version = 1;
+    const char*                  magic   = "NPVTX4D";
+
+    std::size_t size() const { return std::size_t(nbins[0]) * nbins[1] * nbins[2] * nbins[3]; }
+
+    /// Write to a file in the temporary directory; returns its path
+    std::string write(const std::string& name) const {
+      const auto    path = (std::filesystem::temp_directory_path() / ("npdet_vertex_" + name + ".bin")).string();
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      char          header_magic[8] = {};
+      std::strncpy(header_magic, magic, sizeof(header_magic) - 1);
+      const std::uint32_t reserved = 0;
+      out.write(header_magic, sizeof(header_magic));
+      out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+      out.write(reinterpret_cast<const char*>(nbins.data()), sizeof(nbins));
+      out.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+      out.write(reinterpret_cast<const char*>(lo.data()), sizeof(lo));
+      out.write(reinterpret_cast<const char*>(hi.data()), sizeof(hi));
+      out.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(double));
+      return path;
+    }
+
+    /// Bin index of a vertex, as in the file
+    std::size_t bin(const std::array<double, 4>& v) const {
+      std::array<std::size_t, 4> i{};
+      for (int d = 0; d < 4; ++d) {
+        i[d] = static_cast<std::size_t>((v[d] - lo[d]) / (hi[d] - lo[d]) * nbins[d]);
+      }
+      return ((i[0] * nbins[1] + i[1]) * nbins[2] + i[2]) * nbins[3] + i[3];
+    }
+  };
+
+  /// Weights with a wide range, including empty bins
+  TestFile skewedFile() {
+    TestFile file;
+    for (std::size_t i = 0; i < file.size(); ++i) {
+      file.weights.push_back(i % 5 == 0 ? 0. : double((i * 7) % 11) + 0.25 * i);
+    }
+    return file;
+  }
+
+} // namespace
+
+TEST_CASE("Alias table reproduces the bin weights", "[vertex_distribution]") {
+  const TestFile           file = skewedFile();
+  const VertexDistribution table(file.write("weights"));
+  REQUIRE(table.size() == file.size());
+
+  // Scan both uniform numbers of the bin selection on a fine grid: every
+  // table slot has the same probability, split between the slot's own bin
+  // and its alias.
+  const std::size_t   steps = 20000;
+  std::vector<double> mass(file.size(), 0.);
+  for (std::size_t slot = 0; slot < table.size(); ++slot) {
+    const double u_bin = (slot + 0.5) / table.size();
+    for (std::size_t k = 0; k < steps; ++k) {
+      const auto v = table.sample(u_bin, (k + 0.5) / steps, 0.5, 0.5, 0.5, 0.5);
+      mass[file.bin(v)] += 1. / (table.size() * steps);
+    }
+  }
+  double total = 0;
+  for (double w : file.weights) {
+    total += w;
+  }
+  for (std::size_t i = 0; i < file.size(); ++i) {
+    INFO("bin " << i);
+    if (file.weights[i] == 0.) {
+      CHECK(mass[i] == 0.);
+    } else {
+      CHECK(mass[i] == Approx(file.weights[i] / total).margin(1e-4));
+    }
+  }
+}
+
+TEST_CASE("Vertices are spread over the selected bin", "[vertex_distribution]") {
+  TestFile file;
+  file.weights.assign(file.size(), 0.);
+  // A single populated bin: ix = 2, iy = 0, iz = 1, it = 1
+  const std::size_t only = ((2 * file.nbins[1] + 0) * file.nbins[2] + 1) * file.nbins[3] + 1;
+  file.weights[only]     = 3.;
+  const VertexDistribution table(file.write("single"));
+
+  for (double u_bin : {0., 0.3, 0.999}) {
+    for (double u_alias : {0., 0.5, 0.999}) {
+      const auto low  = table.sample(u_bin, u_alias, 0., 0., 0., 0.);
+      const auto high = table.sample(u_bin, u_alias, 1., 1., 1., 1.);
+      CHECK(low[0] == Approx(1. / 3.));
+      CHECK(high[0] == Approx(1.));
+      CHECK(low[1] == Approx(-0.5));
+      CHECK(high[1] == Approx(0.));
+      CHECK(low[2] == Approx(-50.));
+      CHECK(high[2] == Approx(0.));
+      CHECK(low[3] == Approx(0.));
+      CHECK(high[3] == Approx(0.2));
+    }
+  }
+}
+
+TEST_CASE("Malformed files are rejected", "[vertex_distribution]") {
+  const std::string missing = (std::filesystem::temp_directory_path() / "npdet_vertex_missing.bin").string();
+  std::filesystem::remove(missing);
+  CHECK_THROWS_AS(VertexDistribution(missing), std::runtime_error);
+
+  TestFile magic = skewedFile();
+  magic.magic    = "NPVTX3D";
+  CHECK_THROWS_AS(VertexDistribution(magic.write("magic")), std::runtime_error);
+
+  TestFile version = skewedFile();
+  version.version  = 2;
+  CHECK_THROWS_AS(VertexDistribution(version.write("version")), std::runtime_error);
+
+  TestFile axis = skewedFile();
+  axis.hi[2]    = axis.lo[2];
+  CHECK_THROWS_AS(VertexDistribution(axis.write("axis")), std::runtime_error);
+
+  TestFile truncated = skewedFile();
+  truncated.weights.pop_back();
+  CHECK_THROWS_AS(VertexDistribution(truncated.write("truncated")), std::runtime_error);
+
+  TestFile negative   = skewedFile();
+  negative.weights[3] = -1.;
+  CHECK_THROWS_AS(VertexDistribution(negative.write("negative")), std::runtime_error);
+
+  TestFile nan   = skewedFile();
+  nan.weights[4] = std::nan("");
+  CHECK_THROWS_AS(VertexDistribution(nan.write("nan")), std::runtime_error);
+
+  TestFile empty = skewedFile();
+  empty.weights.assign(empty.size(), 0.);
+  CHECK_THROWS_AS(VertexDistribution(empty.write("empty")), std::runtime_error);
+}
+
+TEST_CASE("Shared tables are loaded once per file", "[vertex_distribution]") {
+  const std::string path   = skewedFile().write("shared");
+  const auto        first  = VertexDistribution::shared(path);
+  const auto        second = VertexDistribution::shared(path);
+  CHECK(first == second);
+  CHECK(first->size() == skewedFile().size());
+}
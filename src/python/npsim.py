@@ -22,6 +22,22 @@ if __name__ == "__main__":
 
   RUNNER.part.userParticleHandler = "Geant4TVEicParticleHandler"
 
+  # Apply the hpDIRC efficiency at Cerenkov photon generation instead of in
+  # the stacking action: --physics.cerenkovQE or SIM.physics.cerenkovQE
+  from DDSim.Helper.ConfigHelper import ConfigHelper
+  from DDSim.Helper.Physics import Physics as _Physics
+
+  def _getCerenkovQE(self):
+    """Apply the hpDIRC photon detection efficiency at Cerenkov photon generation instead of in the
+    stacking action. Photons outside the efficiency wavelength range are then treated as undetected
+    instead of being kept."""
+    return getattr(self, "_cerenkovQE", False)
+
+  def _setCerenkovQE(self, val):
+    self._cerenkovQE = ConfigHelper.makeBoolean(val)
+
+  _Physics.cerenkovQE = property(_getCerenkovQE, _setCerenkovQE)
+
   # Parse remaining options (command line and steering file override above)
   # This is done before updating the settings to workaround issue reported in
   # https://github.com/AIDASoft/DD4hep/pull/1376
@@ -31,7 +47,13 @@ if __name__ == "__main__":
   def setupCerenkov(kernel):
     from DDG4 import PhysicsList
     seq = kernel.physicsList()
-    cerenkov = PhysicsList(kernel, 'Geant4CerenkovPhysics/CerenkovPhys')
+    if RUNNER.physics.cerenkovQE:
+      cerenkov = PhysicsList(kernel, 'QuantumEfficiencyCerenkovPhysics/CerenkovPhys')
+      for key, value in DIRC_QE.items():
+        setattr(cerenkov, key, value)
+      logger.info(" *** Cerenkov photon efficiency applied at generation ***")
+    else:
+      cerenkov = PhysicsList(kernel, 'Geant4CerenkovPhysics/CerenkovPhys')
     cerenkov.MaxNumPhotonsPerStep = 10
     cerenkov.MaxBetaChangePerStep = 10.0
     cerenkov.TrackSecondariesFirst = False
@@ -61,7 +83,10 @@ if __name__ == "__main__":
       logger.info("    BackwardRegionZ       = %s", handler.BackwardRegionZ)
       logger.info("    ForwardMomentumMin    = %s", handler.ForwardMomentumMin)
       logger.info("    BackwardMomentumMin   = %s", handler.BackwardMomentumMin)
+      logger.info("    RegionCuts            = %s", handler.RegionCuts)
       logger.info("    KeepCaloHitParticles  = %s", handler.KeepCaloHitParticles)
+      logger.info("    FastContainment       = %s", handler.FastContainment)
+      logger.info("    StatisticsFile        = %s", handler.StatisticsFile)
       logger.info(" ******************************************")
 
       part.adopt(handler)
@@ -95,37 +120,43 @@ if __name__ == "__main__":
   RUNNER.action.mapActions['PFRICH'] = 'Geant4OpticalTrackerAction'
   RUNNER.action.mapActions['DIRC'] = 'Geant4OpticalTrackerAction'
 
-  # Use the optical photon efficiency stacking action for hpDIRC
-  RUNNER.action.stack = [
-    {
-      "name": "OpticalPhotonEfficiencyStackingAction",
-      "parameter": {
-        "LambdaMin": "180*nm",
-        "LambdaMax": "678*nm",
-        "Region": "DIRCRegion",
-        "LogicalVolume": r"(bar_vol|glue_vol|lens_layer\d_vol|prism_vol|mcp_vol|Envelope_box_vol|Envelope_trap_vol)",
-        "Efficiency": [e/100. for e in [
-          0,    0,    14.0, 14.8, 14.5, 14.9, 14.4, 14.2, 13.9, 14.6, 15.2, 15.7, 16.4, 16.9, 17.5,
-          17.7, 18.1, 18.8, 19.3, 19.8, 20.6, 21.4, 22.4, 23.1, 23.6, 24.1, 24.2, 24.6, 24.8, 25.2,
-          25.7, 26.5, 27.1, 28.2, 29.0, 29.9, 30.8, 31.1, 31.7, 31.8, 31.6, 31.5, 31.5, 31.3, 31.0,
-          30.8, 30.8, 30.4, 30.2, 30.3, 30.2, 30.1, 30.1, 30.1, 29.8, 29.9, 29.8, 29.7, 29.7, 29.7,
-          29.8, 29.8, 29.9, 29.9, 29.8, 29.9, 29.8, 29.9, 29.8, 29.7, 29.8, 29.7, 29.8, 29.6, 29.5,
-          29.7, 29.7, 29.8, 30.1, 30.4, 31.0, 31.3, 31.5, 31.8, 31.8, 31.9, 32.0, 32.0, 32.0, 32.0,
-          32.2, 32.2, 32.1, 31.8, 31.8, 31.8, 31.7, 31.6, 31.6, 31.7, 31.5, 31.5, 31.4, 31.3, 31.3,
-          31.2, 30.8, 30.7, 30.5, 30.3, 29.9, 29.5, 29.3, 29.2, 28.6, 28.2, 27.9, 27.8, 27.3, 27.0,
-          26.6, 26.1, 25.9, 25.5, 25.0, 24.6, 24.2, 23.8, 23.4, 23.0, 22.7, 22.4, 21.9, 21.4, 21.2,
-          20.7, 20.3, 19.8, 19.6, 19.3, 18.9, 18.7, 18.3, 17.9, 17.8, 17.8, 16.7, 16.5, 16.4, 16.0,
-          15.6, 15.6, 15.2, 14.9, 14.6, 14.4, 14.1, 13.8, 13.6, 13.3, 13.0, 12.8, 12.6, 12.3, 12.0,
-          11.9, 11.7, 11.5, 11.2, 11.1, 10.9, 10.7, 10.4, 10.3, 9.9,  9.8,  9.6,  9.3,  9.1,  9.0,
-          8.8,  8.5,  8.3,  8.3,  8.2,  7.9,  7.8,  7.7,  7.5,  7.3,  7.1,  6.9,  6.7,  6.6,  6.3,
-          6.2,  6.0,  5.8,  5.7,  5.6,  5.4,  5.2,  5.1,  4.9,  4.8,  4.6,  4.5,  4.4,  4.2,  4.1,
-          4.0,  3.8,  3.7,  3.5,  3.3,  3.2,  3.1,  3.0,  2.9,  2.5,  2.4,  2.4,  2.3,  2.3,  2.1,
-          1.8,  1.6,  1.5,  1.5,  1.6,  1.8,  1.9,  1.4,  0.8,  0.9,  0.8,  0.7,  0.6,  0.3,  0.3,
-          0.5,  0.3,  0.4,  0.3,  0.1,  0.2,  0.1,  0.2,  0.3,  0.0
-        ]]
+  # hpDIRC photon detection efficiency, on a uniform wavelength grid
+  DIRC_EFFICIENCY = [e/100. for e in [
+    0,    0,    14.0, 14.8, 14.5, 14.9, 14.4, 14.2, 13.9, 14.6, 15.2, 15.7, 16.4, 16.9, 17.5,
+    17.7, 18.1, 18.8, 19.3, 19.8, 20.6, 21.4, 22.4, 23.1, 23.6, 24.1, 24.2, 24.6, 24.8, 25.2,
+    25.7, 26.5, 27.1, 28.2, 29.0, 29.9, 30.8, 31.1, 31.7, 31.8, 31.6, 31.5, 31.5, 31.3, 31.0,
+    30.8, 30.8, 30.4, 30.2, 30.3, 30.2, 30.1, 30.1, 30.1, 29.8, 29.9, 29.8, 29.7, 29.7, 29.7,
+    29.8, 29.8, 29.9, 29.9, 29.8, 29.9, 29.8, 29.9, 29.8, 29.7, 29.8, 29.7, 29.8, 29.6, 29.5,
+    29.7, 29.7, 29.8, 30.1, 30.4, 31.0, 31.3, 31.5, 31.8, 31.8, 31.9, 32.0, 32.0, 32.0, 32.0,
+    32.2, 32.2, 32.1, 31.8, 31.8, 31.8, 31.7, 31.6, 31.6, 31.7, 31.5, 31.5, 31.4, 31.3, 31.3,
+    31.2, 30.8, 30.7, 30.5, 30.3, 29.9, 29.5, 29.3, 29.2, 28.6, 28.2, 27.9, 27.8, 27.3, 27.0,
+    26.6, 26.1, 25.9, 25.5, 25.0, 24.6, 24.2, 23.8, 23.4, 23.0, 22.7, 22.4, 21.9, 21.4, 21.2,
+    20.7, 20.3, 19.8, 19.6, 19.3, 18.9, 18.7, 18.3, 17.9, 17.8, 17.8, 16.7, 16.5, 16.4, 16.0,
+    15.6, 15.6, 15.2, 14.9, 14.6, 14.4, 14.1, 13.8, 13.6, 13.3, 13.0, 12.8, 12.6, 12.3, 12.0,
+    11.9, 11.7, 11.5, 11.2, 11.1, 10.9, 10.7, 10.4, 10.3, 9.9,  9.8,  9.6,  9.3,  9.1,  9.0,
+    8.8,  8.5,  8.3,  8.3,  8.2,  7.9,  7.8,  7.7,  7.5,  7.3,  7.1,  6.9,  6.7,  6.6,  6.3,
+    6.2,  6.0,  5.8,  5.7,  5.6,  5.4,  5.2,  5.1,  4.9,  4.8,  4.6,  4.5,  4.4,  4.2,  4.1,
+    4.0,  3.8,  3.7,  3.5,  3.3,  3.2,  3.1,  3.0,  2.9,  2.5,  2.4,  2.4,  2.3,  2.3,  2.1,
+    1.8,  1.6,  1.5,  1.5,  1.6,  1.8,  1.9,  1.4,  0.8,  0.9,  0.8,  0.7,  0.6,  0.3,  0.3,
+    0.5,  0.3,  0.4,  0.3,  0.1,  0.2,  0.1,  0.2,  0.3,  0.0
+  ]]
+  DIRC_QE = {
+    "LambdaMin": "180*nm",
+    "LambdaMax": "678*nm",
+    "Region": "DIRCRegion",
+    "LogicalVolume": r"(bar_vol|glue_vol|lens_layer\d_vol|prism_vol|mcp_vol|Envelope_box_vol|Envelope_trap_vol)",
+    "Efficiency": DIRC_EFFICIENCY,
+  }
+
+  # Use the optical photon efficiency stacking action for hpDIRC, unless the
+  # efficiency is applied at generation (physics.cerenkovQE)
+  if not RUNNER.physics.cerenkovQE:
+    RUNNER.action.stack = [
+      {
+        "name": "OpticalPhotonEfficiencyStackingAction",
+        "parameter": DIRC_QE,
       }
-    }
-  ]
+    ]
 
   try:
     sys.exit(RUNNER.run())
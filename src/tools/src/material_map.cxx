@@ -0,0 +1,420 @@
+#include "material_map.h"
+
+#include "TCollection.h"
+#include "TDirectory.h"
+#include "TGeoBBox.h"
+#include "TGeoMatrix.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "THStack.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace npdet::mat {
+
+  namespace {
+    /// Navigator of the calling thread, created on first use
+    TGeoNavigator* thread_navigator(dd4hep::Volume world) {
+      TGeoManager*   geo = world->GetGeoManager();
+      TGeoNavigator* nav = geo->GetCurrentNavigator();
+      if (!nav) {
+        nav = geo->AddNavigator();
+      }
+      return nav;
+    }
+
+    void collect_nodes(const TGeoNode* node, std::unordered_set<const TGeoNode*>& nodes) {
+      if (!nodes.insert(node).second) {
+        return;
+      }
+      const TGeoVolume* vol = node->GetVolume();
+      for (int i = 0; i < vol->GetNdaughters(); ++i) {
+        collect_nodes(vol->GetNode(i), nodes);
+      }
+    }
+
+    MaterialMap empty_map(const MapBinning& binning, const Vector3D& origin, double r_max) {
+      return MaterialMap{binning, origin, r_max, std::vector<double>(binning.size()),
+                         std::vector<double>(binning.size()), std::vector<double>(binning.size())};
+    }
+
+    /// Bound on the steps of a single ray, against navigation getting stuck on a boundary
+    constexpr int max_steps = 1000000;
+  } // namespace
+
+  PlacementFilter::PlacementFilter(dd4hep::DetElement detector) : m_all(false) {
+    collect_nodes(detector.placement().ptr(), m_nodes);
+  }
+
+  SubsystemIndex::SubsystemIndex(dd4hep::Detector& description, const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+      if (std::find(m_names.begin(), m_names.end(), name) != m_names.end()) {
+        continue;
+      }
+      m_slots[description.detector(name).placement().ptr()] = m_names.size();
+      m_names.push_back(name);
+    }
+  }
+
+  ScanWorker::ScanWorker(dd4hep::Volume world) : m_navigator(thread_navigator(world)), m_manager(world) {}
+
+  RayBudget ScanWorker::trace(const Vector3D& p0, const Vector3D& p1, const PlacementFilter& filter) {
+    RayBudget budget;
+    for (const auto& [pv, length] : m_manager.placementsBetween(p0, p1)) {
+      if (!filter.accepts(pv.ptr())) {
+        continue;
+      }
+      dd4hep::Material mat = pv.volume().material();
+      budget.x0 += length / mat.radLength();
+      budget.lambda += length / mat.intLength();
+      budget.length += length;
+    }
+    return budget;
+  }
+
+  void ScanWorker::trace(const Vector3D& p0, const Vector3D& p1, const SubsystemIndex& index, RayBudget* budgets) {
+    steps(p0, p1, [&](const TGeoNode* top, const TGeoMaterial* mat, double, double step) {
+      RayBudget& budget = budgets[index.slot(top)];
+      budget.x0 += step / mat->GetRadLen();
+      budget.lambda += step / mat->GetIntLen();
+      budget.length += step;
+    });
+  }
+
+  void ScanWorker::steps(const Vector3D& p0, const Vector3D& p1,
+                         const std::function<void(const TGeoNode*, const TGeoMaterial*, double, double)>& fn) {
+    const Vector3D d        = p1 - p0;
+    const double   distance = d.r();
+    if (distance <= 0) {
+      return;
+    }
+    double point[3]     = {p0.x(), p0.y(), p0.z()};
+    double direction[3] = {d.x() / distance, d.y() / distance, d.z() / distance};
+    m_navigator->InitTrack(point, direction);
+
+    double remaining = distance;
+    for (int n = 0; remaining > 0 && !m_navigator->IsOutside() && n < max_steps; ++n) {
+      const TGeoNode* node  = m_navigator->GetCurrentNode();
+      const int       level = m_navigator->GetLevel();
+      const TGeoNode* top   = level > 0 ? m_navigator->GetMother(level - 1) : nullptr;
+      m_navigator->FindNextBoundaryAndStep(remaining);
+      const double step = std::min(m_navigator->GetStep(), remaining);
+      fn(top, node->GetVolume()->GetMaterial(), distance - remaining, step);
+      remaining -= step;
+    }
+  }
+
+  unsigned thread_count(int requested) {
+    if (requested > 0) {
+      return requested;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  void parallel_for(dd4hep::Detector& description, unsigned n_threads, std::size_t n,
+                    const std::function<void(ScanWorker&, std::size_t)>& fn) {
+    dd4hep::Volume world = description.world().volume();
+    TGeoManager*   geo   = world->GetGeoManager();
+    n_threads            = std::max(1u, std::min<unsigned>(n_threads, std::max<std::size_t>(n, 1)));
+    if (!geo->IsMultiThread() || TGeoManager::GetMaxThreads() < int(n_threads)) {
+      geo->SetMaxThreads(n_threads);
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr       error;
+    std::mutex               error_lock;
+    auto work = [&]() {
+      try {
+        ScanWorker worker(world);
+        for (std::size_t i = next++; i < n; i = next++) {
+          fn(worker, i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_lock);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = n;
+      }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < n_threads; ++t) {
+      pool.emplace_back(work);
+    }
+    for (auto& t : pool) {
+      t.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::uint64_t geometry_hash(dd4hep::Detector& description) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, std::size_t size) {
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+      }
+    };
+    auto add_name  = [&add](const char* name) { add(name, std::strlen(name) + 1); };
+    auto add_value = [&add](double value) { add(&value, sizeof(value)); };
+
+    TGeoManager* geo = description.world().volume()->GetGeoManager();
+    TIter        next(geo->GetListOfVolumes());
+    while (auto* vol = static_cast<TGeoVolume*>(next())) {
+      add_name(vol->GetName());
+      const TGeoShape* shape = vol->GetShape();
+      add_name(shape->ClassName());
+      if (const auto* box = dynamic_cast<const TGeoBBox*>(shape)) {
+        add_value(box->GetDX());
+        add_value(box->GetDY());
+        add_value(box->GetDZ());
+        add(box->GetOrigin(), 3 * sizeof(double));
+      }
+      if (const TGeoMaterial* mat = vol->GetMaterial()) {
+        add_name(mat->GetName());
+        add_value(mat->GetDensity());
+        add_value(mat->GetRadLen());
+        add_value(mat->GetIntLen());
+      }
+      for (int i = 0; i < vol->GetNdaughters(); ++i) {
+        const TGeoNode* node = vol->GetNode(i);
+        add_name(node->GetVolume()->GetName());
+        add(node->GetMatrix()->GetTranslation(), 3 * sizeof(double));
+        add(node->GetMatrix()->GetRotationMatrix(), 9 * sizeof(double));
+      }
+    }
+    return hash;
+  }
+
+  Vector3D MapBinning::direction(int i_eta, int i_phi) const {
+    const double theta = 2.0 * std::atan(std::exp(-eta(i_eta)));
+    const double phi   = this->phi(i_phi);
+    return Vector3D(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+  }
+
+  double MaterialMap::mean_x0(int i_eta) const {
+    double sum = 0;
+    for (int j = 0; j < binning.n_phi; ++j) {
+      sum += x0[binning.index(i_eta, j)];
+    }
+    return sum / binning.n_phi;
+  }
+
+  double MaterialMap::mean_lambda(int i_eta) const {
+    double sum = 0;
+    for (int j = 0; j < binning.n_phi; ++j) {
+      sum += lambda[binning.index(i_eta, j)];
+    }
+    return sum / binning.n_phi;
+  }
+
+  void MaterialMap::write(TDirectory* dir) const {
+    const auto& b = binning;
+    TDirectory::TContext context(dir);
+    auto* hx1 = new TH1D("x0_eta", "X/X_{0};#eta;X/X_{0}", b.n_eta, b.eta_min, b.eta_max);
+    auto* hl1 = new TH1D("lambda_eta", "#lambda/#lambda_{0};#eta;#lambda/#lambda_{0}", b.n_eta, b.eta_min, b.eta_max);
+    auto* hx2 = new TH2D("x0_eta_phi", "X/X_{0};#eta;#phi [rad]", b.n_eta, b.eta_min, b.eta_max, b.n_phi, b.phi_min,
+                         b.phi_max);
+    auto* hl2 = new TH2D("lambda_eta_phi", "#lambda/#lambda_{0};#eta;#phi [rad]", b.n_eta, b.eta_min, b.eta_max,
+                         b.n_phi, b.phi_min, b.phi_max);
+    auto*  tree = new TTree("rays", "Integrated material per ray");
+    double row[5];
+    tree->Branch("eta", &row[0]);
+    tree->Branch("phi", &row[1]);
+    tree->Branch("x0", &row[2]);
+    tree->Branch("lambda", &row[3]);
+    tree->Branch("length", &row[4]);
+    for (int i = 0; i < b.n_eta; ++i) {
+      hx1->SetBinContent(i + 1, mean_x0(i));
+      hl1->SetBinContent(i + 1, mean_lambda(i));
+      for (int j = 0; j < b.n_phi; ++j) {
+        const std::size_t bin = b.index(i, j);
+        hx2->SetBinContent(i + 1, j + 1, x0[bin]);
+        hl2->SetBinContent(i + 1, j + 1, lambda[bin]);
+        row[0] = b.eta(i);
+        row[1] = b.phi(j);
+        row[2] = x0[bin];
+        row[3] = lambda[bin];
+        row[4] = length[bin];
+        tree->Fill();
+      }
+    }
+    tree->ResetBranchAddresses();
+  }
+
+  MaterialMap scan_map(dd4hep::Detector& description, const MapBinning& binning, const Vector3D& origin,
+                       double r_max, unsigned n_threads, const PlacementFilter& filter) {
+    MaterialMap map = empty_map(binning, origin, r_max);
+    parallel_for(description, n_threads, binning.size(), [&](ScanWorker& worker, std::size_t bin) {
+      const int  i_eta  = bin / binning.n_phi;
+      const int  i_phi  = bin % binning.n_phi;
+      const auto budget = worker.trace(origin, origin + r_max * binning.direction(i_eta, i_phi), filter);
+      map.x0[bin]       = budget.x0;
+      map.lambda[bin]   = budget.lambda;
+      map.length[bin]   = budget.length;
+    });
+    return map;
+  }
+
+  std::vector<Vector3D> VertexSpread::sample(const Vector3D& center, int n_origins, std::uint64_t seed) const {
+    std::mt19937_64                  rng(seed);
+    std::normal_distribution<double> gauss;
+    const double                     slope = std::tan(crossing_angle / 2);
+    std::vector<Vector3D>            origins;
+    for (int k = 0; k < n_origins; ++k) {
+      const double x = sigma_x * gauss(rng);
+      const double y = sigma_y * gauss(rng);
+      const double z = sigma_z * gauss(rng);
+      origins.push_back(center + Vector3D(x + z * slope, y, z));
+    }
+    return origins;
+  }
+
+  SpreadMap scan_spread(dd4hep::Detector& description, const MapBinning& binning, const std::vector<Vector3D>& origins,
+                        double r_max, unsigned n_threads) {
+    Vector3D center;
+    for (const auto& origin : origins) {
+      center = center + (1.0 / origins.size()) * origin;
+    }
+    SpreadMap spread{empty_map(binning, center, r_max), empty_map(binning, center, r_max)};
+    parallel_for(description, n_threads, binning.size(), [&](ScanWorker& worker, std::size_t bin) {
+      const Vector3D direction = r_max * binning.direction(bin / binning.n_phi, bin % binning.n_phi);
+      // Welford's running mean and sum of squared deviations of x0, lambda, length
+      double mean[3] = {0, 0, 0}, m2[3] = {0, 0, 0};
+      for (std::size_t k = 0; k < origins.size(); ++k) {
+        const auto   budget   = worker.trace(origins[k], origins[k] + direction);
+        const double value[3] = {budget.x0, budget.lambda, budget.length};
+        for (int q = 0; q < 3; ++q) {
+          const double delta = value[q] - mean[q];
+          mean[q] += delta / (k + 1);
+          m2[q] += delta * (value[q] - mean[q]);
+        }
+      }
+      const double n = std::max<std::size_t>(origins.size(), 1);
+      spread.mean.x0[bin]     = mean[0];
+      spread.mean.lambda[bin] = mean[1];
+      spread.mean.length[bin] = mean[2];
+      spread.rms.x0[bin]      = std::sqrt(m2[0] / n);
+      spread.rms.lambda[bin]  = std::sqrt(m2[1] / n);
+      spread.rms.length[bin]  = std::sqrt(m2[2] / n);
+    });
+    return spread;
+  }
+
+  std::vector<MaterialMap> scan_maps(dd4hep::Detector& description, const MapBinning& binning, const Vector3D& origin,
+                                     double r_max, unsigned n_threads, const SubsystemIndex& index) {
+    std::vector<MaterialMap> maps(index.size(), empty_map(binning, origin, r_max));
+    parallel_for(description, n_threads, binning.size(), [&](ScanWorker& worker, std::size_t bin) {
+      const int              i_eta = bin / binning.n_phi;
+      const int              i_phi = bin % binning.n_phi;
+      std::vector<RayBudget> budgets(index.size());
+      worker.trace(origin, origin + r_max * binning.direction(i_eta, i_phi), index, budgets.data());
+      for (std::size_t k = 0; k < budgets.size(); ++k) {
+        maps[k].x0[bin]     = budgets[k].x0;
+        maps[k].lambda[bin] = budgets[k].lambda;
+        maps[k].length[bin] = budgets[k].length;
+      }
+    });
+    return maps;
+  }
+
+  MaterialMap total(const std::vector<MaterialMap>& maps) {
+    MaterialMap sum = empty_map(maps.front().binning, maps.front().origin, maps.front().r_max);
+    for (const auto& map : maps) {
+      for (std::size_t bin = 0; bin < sum.x0.size(); ++bin) {
+        sum.x0[bin] += map.x0[bin];
+        sum.lambda[bin] += map.lambda[bin];
+        sum.length[bin] += map.length[bin];
+      }
+    }
+    return sum;
+  }
+
+  void write_stack(TDirectory* dir, const std::vector<std::pair<std::string, const MaterialMap*>>& maps) {
+    static const int colors[] = {kAzure - 4, kRed - 7,    kGreen - 6, kOrange - 3, kMagenta - 7, kCyan - 6,
+                                 kYellow - 6, kViolet - 6, kPink + 1,  kSpring - 5, kTeal - 6,    kGray + 1};
+    auto* sx = new THStack("x0_eta_stack", "X/X_{0};#eta;X/X_{0}");
+    auto* sl = new THStack("lambda_eta_stack", "#lambda/#lambda_{0};#eta;#lambda/#lambda_{0}");
+    std::size_t n = 0;
+    for (const auto& [name, map] : maps) {
+      const auto& b  = map->binning;
+      auto*       hx = new TH1D(("x0_eta_" + name).c_str(), name.c_str(), b.n_eta, b.eta_min, b.eta_max);
+      auto*       hl = new TH1D(("lambda_eta_" + name).c_str(), name.c_str(), b.n_eta, b.eta_min, b.eta_max);
+      for (int i = 0; i < b.n_eta; ++i) {
+        hx->SetBinContent(i + 1, map->mean_x0(i));
+        hl->SetBinContent(i + 1, map->mean_lambda(i));
+      }
+      const int color = colors[n++ % std::size(colors)];
+      for (auto* h : {hx, hl}) {
+        h->SetDirectory(nullptr);
+        h->SetFillColor(color);
+        h->SetLineColor(color);
+      }
+      sx->Add(hx);
+      sl->Add(hl);
+    }
+    dir->Append(sx);
+    dir->Append(sl);
+  }
+
+  bool write_columns(const std::string& path, const std::vector<std::pair<std::string, const MaterialMap*>>& maps) {
+    if (maps.empty()) {
+      return false;
+    }
+    const MapBinning& b = maps.front().second->binning;
+    std::vector<double> eta(b.size()), phi(b.size());
+    for (int i = 0; i < b.n_eta; ++i) {
+      for (int j = 0; j < b.n_phi; ++j) {
+        eta[b.index(i, j)] = b.eta(i);
+        phi[b.index(i, j)] = b.phi(j);
+      }
+    }
+    std::vector<std::string>   names = {"eta", "phi"};
+    std::vector<const double*> data  = {eta.data(), phi.data()};
+    for (const auto& [name, map] : maps) {
+      if (map->x0.size() != b.size()) {
+        return false;
+      }
+      names.insert(names.end(), {name + ".x0", name + ".lambda", name + ".length"});
+      data.insert(data.end(), {map->x0.data(), map->lambda.data(), map->length.data()});
+    }
+
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+      return false;
+    }
+    const char          magic[8] = {'N', 'P', 'M', 'A', 'T', 'M', 'A', 'P'};
+    const std::uint32_t head[2]  = {1, std::uint32_t(names.size())};
+    const std::uint64_t n_rows   = b.size();
+    bool ok = std::fwrite(magic, sizeof(magic), 1, out) == 1 && std::fwrite(head, sizeof(head), 1, out) == 1 &&
+              std::fwrite(&n_rows, sizeof(n_rows), 1, out) == 1;
+    for (const auto& name : names) {
+      char field[64] = {};
+      std::strncpy(field, name.c_str(), sizeof(field) - 1);
+      ok = ok && std::fwrite(field, sizeof(field), 1, out) == 1;
+    }
+    for (const double* column : data) {
+      ok = ok && std::fwrite(column, sizeof(double), n_rows, out) == n_rows;
+    }
+    ok = std::fclose(out) == 0 && ok;
+    return ok;
+  }
+
+} // namespace npdet::mat
@@ -0,0 +1,231 @@
+#ifndef NPDET_TOOLS_MATERIAL_MAP_H
+#define NPDET_TOOLS_MATERIAL_MAP_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "DD4hep/Detector.h"
+#include "DDRec/MaterialManager.h"
+#include "DDRec/Vector3D.h"
+
+class TDirectory;
+class TGeoMaterial;
+class TGeoNavigator;
+class TGeoNode;
+
+namespace npdet::mat {
+
+  using dd4hep::rec::Vector3D;
+
+  /// Integrated material along a ray
+  struct RayBudget {
+    double x0     = 0; // X/X0
+    double lambda = 0; // lambda/lambda0
+    double length = 0; // path length [cm]
+  };
+
+  /// Placements of one subsystem, as selected by MaterialScan::setDetector
+  /**
+   *  A default constructed filter accepts every placement.
+   */
+  class PlacementFilter {
+  public:
+    PlacementFilter() = default;
+    /// All placements in the placement tree of a detector element
+    explicit PlacementFilter(dd4hep::DetElement detector);
+
+    bool accepts(const TGeoNode* node) const { return m_all || m_nodes.count(node) > 0; }
+
+  private:
+    bool                                m_all = true;
+    std::unordered_set<const TGeoNode*> m_nodes;
+  };
+
+  /// Slots for the top-level subsystems a step can be attributed to
+  /**
+   *  Slot 0, "other", takes the material of the world volume itself and of
+   *  all top-level placements not listed.
+   */
+  class SubsystemIndex {
+  public:
+    /// One slot per named top-level detector, in the given order; repeated names are skipped
+    SubsystemIndex(dd4hep::Detector& description, const std::vector<std::string>& names);
+
+    std::size_t        size() const { return m_names.size(); }
+    const std::string& name(std::size_t slot) const { return m_names[slot]; }
+    /// Slot of a top-level (level 1) placement
+    std::size_t slot(const TGeoNode* top) const {
+      auto it = m_slots.find(top);
+      return it == m_slots.end() ? 0 : it->second;
+    }
+
+  private:
+    std::vector<std::string>                         m_names = {"other"};
+    std::unordered_map<const TGeoNode*, std::size_t> m_slots;
+  };
+
+  /// Navigation state of one scan thread.
+  /**
+   *  TGeo keeps the navigation state in the navigator, so every thread gets
+   *  its own navigator on the shared, closed TGeoManager, and its own
+   *  MaterialManager, which navigates with the navigator of the calling thread.
+   */
+  class ScanWorker {
+  public:
+    explicit ScanWorker(dd4hep::Volume world);
+    ScanWorker(const ScanWorker&) = delete;
+    ScanWorker& operator=(const ScanWorker&) = delete;
+
+    /// Materials between two points
+    const dd4hep::rec::MaterialVec& materials(const Vector3D& p0, const Vector3D& p1) {
+      return m_manager.materialsBetween(p0, p1);
+    }
+    /// Integrated X/X0 and lambda/lambda0 between two points, counting only placements passing the filter
+    RayBudget trace(const Vector3D& p0, const Vector3D& p1, const PlacementFilter& filter = {});
+    /// Add the material between two points to budgets[index.slot(top-level placement of each step)]
+    /**
+     *  A single pass through the full world: every step is attributed to
+     *  the level 1 node of the navigator's current path.
+     */
+    void trace(const Vector3D& p0, const Vector3D& p1, const SubsystemIndex& index, RayBudget* budgets);
+    /// Calls fn(top, material, t, step) for each navigation step between two points
+    /**
+     *  top is the level 1 node of the step (nullptr in the world volume), t
+     *  the distance of the step start from p0 and step its length [cm].
+     */
+    void steps(const Vector3D& p0, const Vector3D& p1,
+               const std::function<void(const TGeoNode*, const TGeoMaterial*, double, double)>& fn);
+
+  private:
+    TGeoNavigator*              m_navigator = nullptr;
+    dd4hep::rec::MaterialManager m_manager;
+  };
+
+  /// Calls fn(worker, i) for every i in [0, n) on n_threads threads.
+  /**
+   *  Rays differ a lot in cost (forward rays cross far more volumes than
+   *  rays through the barrel gap), so indices are not split up front: each
+   *  thread takes the next unclaimed index from a shared counter until none
+   *  are left. fn must only write to data owned by index i.
+   */
+  void parallel_for(dd4hep::Detector& description, unsigned n_threads, std::size_t n,
+                    const std::function<void(ScanWorker&, std::size_t)>& fn);
+
+  /// Number of threads to use for a requested count; 0 means all cores
+  unsigned thread_count(int requested);
+
+  /// Hash (FNV-1a) of the logical volumes: names, shapes and bounding boxes, materials and daughter placements
+  std::uint64_t geometry_hash(dd4hep::Detector& description);
+
+  /// Eta-phi binning of a material map; rays go through the bin centers
+  struct MapBinning {
+    int    n_eta   = 30;
+    double eta_min = -4;
+    double eta_max = 4;
+    int    n_phi   = 1;
+    double phi_min = -M_PI;
+    double phi_max = M_PI;
+
+    std::size_t size() const { return std::size_t(n_eta) * n_phi; }
+    std::size_t index(int i_eta, int i_phi) const { return std::size_t(i_eta) * n_phi + i_phi; }
+    double eta(int i_eta) const { return eta_min + (i_eta + 0.5) * (eta_max - eta_min) / n_eta; }
+    double phi(int i_phi) const { return phi_min + (i_phi + 0.5) * (phi_max - phi_min) / n_phi; }
+    /// Unit vector at the center of a bin
+    Vector3D direction(int i_eta, int i_phi) const;
+  };
+
+  /// Integrated material per eta-phi bin, from a common origin out to r_max
+  struct MaterialMap {
+    MapBinning          binning;
+    Vector3D            origin;
+    double              r_max = 150;
+    std::vector<double> x0;
+    std::vector<double> lambda;
+    std::vector<double> length;
+
+    /// X/X0 averaged over phi
+    double mean_x0(int i_eta) const;
+    /// lambda/lambda0 averaged over phi
+    double mean_lambda(int i_eta) const;
+    /// Create the maps in dir; they are saved with its file
+    /**
+     *  TH1D x0_eta and lambda_eta (averaged over phi), TH2D x0_eta_phi and
+     *  lambda_eta_phi, and TTree rays with one entry per bin (eta, phi, x0,
+     *  lambda, length).
+     */
+    void write(TDirectory* dir) const;
+  };
+
+  /// Trace one ray per bin on n_threads threads, counting only placements passing the filter
+  MaterialMap scan_map(dd4hep::Detector& description, const MapBinning& binning, const Vector3D& origin,
+                       double r_max, unsigned n_threads, const PlacementFilter& filter = {});
+
+  /// Spread of the primary vertex around the nominal interaction point
+  /**
+   *  Gaussian in x, y and z [cm]. With a crossing angle the luminous region
+   *  is tilted in the x-z plane along the bisector of the beams, so a vertex
+   *  at z is displaced by z * tan(crossing_angle / 2) in x.
+   */
+  struct VertexSpread {
+    double sigma_x        = 0;
+    double sigma_y        = 0;
+    double sigma_z        = 3;
+    double crossing_angle = 0.025; // [rad]
+
+    /// n_origins vertices around center, reproducible for a given seed
+    std::vector<Vector3D> sample(const Vector3D& center, int n_origins, std::uint64_t seed) const;
+  };
+
+  /// Mean and RMS over a set of ray origins, per eta-phi bin; the origin of both maps is the mean origin
+  struct SpreadMap {
+    MaterialMap mean;
+    MaterialMap rms;
+  };
+
+  /// Trace the rays of every bin from each of the origins on n_threads threads
+  /**
+   *  A bin's rays all go in the direction of its center, each out to r_max
+   *  from its own origin, and are traced by the same thread, so the mean
+   *  and RMS are accumulated without storing the individual rays.
+   */
+  SpreadMap scan_spread(dd4hep::Detector& description, const MapBinning& binning, const std::vector<Vector3D>& origins,
+                        double r_max, unsigned n_threads);
+
+  /// Trace one ray per bin on n_threads threads, with one map per slot of the index
+  std::vector<MaterialMap> scan_maps(dd4hep::Detector& description, const MapBinning& binning, const Vector3D& origin,
+                                     double r_max, unsigned n_threads, const SubsystemIndex& index);
+
+  /// Bin by bin sum of maps with a common binning
+  MaterialMap total(const std::vector<MaterialMap>& maps);
+
+  /// Create THStack x0_eta_stack and lambda_eta_stack of the phi-averaged maps in dir
+  void write_stack(TDirectory* dir, const std::vector<std::pair<std::string, const MaterialMap*>>& maps);
+
+  /// Write named maps with a common binning to a flat columnar file; false on I/O errors
+  /**
+   *  File format (native byte order):
+   *
+   *      char     magic[8]     "NPMATMAP"
+   *      uint32   version      1
+   *      uint32   n_columns
+   *      uint64   n_rows       number of eta-phi bins
+   *      char     name[n_columns][64]
+   *      double   column[n_columns][n_rows]
+   *
+   *  Rows are ordered by eta bin, then phi bin. The columns are eta and phi
+   *  followed by <name>.x0, <name>.lambda and <name>.length for every map.
+   *  Each column is contiguous, so it can be memory-mapped or read with
+   *  numpy.fromfile at offset 24 + 64 * n_columns + 8 * n_rows * column.
+   */
+  bool write_columns(const std::string& path, const std::vector<std::pair<std::string, const MaterialMap*>>& maps);
+
+} // namespace npdet::mat
+
+#endif
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2025 EIC Collaboration
+//
+// npdet_hepmc3_index: Write the byte offsets of all event records of HepMC3
+// ASCII files to sidecar index files (<file>.idx).
+//
+// With the index, HEPMC3PrefetchReader starts a job that skips the first N
+// events (npsim --skipNEvents, which scripts/hepmc3_prefetch_steering.py passes
+// on as the input action's Sync) by seeking directly to event N instead of
+// scanning the file up to it. See npdet/HepMC3EventIndex.h for the format.
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "npdet/HepMC3EventIndex.h"
+
+#include "clipp.h"
+using namespace clipp;
+
+using npdet::sim::HepMC3EventIndex;
+
+namespace {
+
+  struct index_settings {
+    bool                     success = false;
+    bool                     help    = false;
+    bool                     check   = false;
+    std::vector<std::string> files;
+  };
+
+  /// Index one file; returns false on errors
+  bool index_file(const std::string& file) {
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+      std::cerr << file << ": " << std::strerror(errno) << "\n";
+      if (fd >= 0) ::close(fd);
+      return false;
+    }
+    HepMC3EventIndex index;
+    if (st.st_size > 0) {
+      void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        std::cerr << file << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+      }
+      ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+      index = HepMC3EventIndex::build(static_cast<const char*>(data), st.st_size);
+      ::munmap(data, st.st_size);
+    }
+    ::close(fd);
+    index.file_mtime = st.st_mtime;
+
+    const std::string idx = HepMC3EventIndex::path(file);
+    if (!index.write(idx)) {
+      std::cerr << idx << ": cannot write index\n";
+      return false;
+    }
+    std::cout << file << ": " << index.offsets.size() << " events\n";
+    return true;
+  }
+
+  /// Check that a file has a current index; returns false otherwise
+  bool check_file(const std::string& file) {
+    HepMC3EventIndex index;
+    if (!HepMC3EventIndex::load(file, index)) {
+      std::cout << file << ": no current index\n";
+      return false;
+    }
+    std::cout << file << ": " << index.offsets.size() << " events indexed\n";
+    return true;
+  }
+
+  void print_usage(const group& cli, const char* argv0) {
+    std::cout << "Usage:\n" << usage_lines(cli, argv0)
+              << "\nOptions:\n" << documentation(cli) << '\n';
+  }
+
+  index_settings cmdline_settings(int argc, char* argv[]) {
+    index_settings s;
+    auto cli = (
+      option("-h", "--help").set(s.help) % "show help",
+      option("-c", "--check").set(s.check) % "only check that the files have a current index",
+      values("files", s.files) % "HepMC3 ASCII files"
+    );
+    assert(cli.flags_are_prefix_free());
+    auto res = parse(argc, argv, cli);
+    if (s.help) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    if (res.any_error() || s.files.empty()) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    s.success = true;
+    return s;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  index_settings s = cmdline_settings(argc, argv);
+  if (s.help) return 0;
+  if (!s.success) return 1;
+
+  bool ok = true;
+  for (const auto& file : s.files) {
+    ok = (s.check ? check_file(file) : index_file(file)) && ok;
+  }
+  return ok ? 0 : 1;
+}
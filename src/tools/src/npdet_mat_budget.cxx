@@ -10,19 +10,22 @@
 
 
 #include "DDRec/MaterialScan.h"
+#include "material_map.h"
 
 // #include "TGeoVolume.h"
 // #include "TGeoManager.h"
 // #include "TGeoNode.h"
 #include "TFile.h"
 #include "TH1F.h"
+#include "TTree.h"
 
 #include <fmt/core.h>
 #include <fstream>
 #include <regex>
+#include <tuple>
 #include "clipp.h"
 using namespace clipp;
-enum class mode { none, help, list, line, scan, rad };// Todo , maybe change rad to something else
+enum class mode { none, help, list, line, scan, stack, vertex, rad };// Todo , maybe change rad to something else
 
 struct settings {
 
@@ -31,12 +34,21 @@ struct settings {
   std::string                   infile     = "";
   std::string                   steering   = "mat_steering.txt";
   std::string                   outfile    = "mat_budget.root";
+  std::string                   columns_file = "";
   std::string                   p_name     = "";
   int                           part_level = -1;
   bool                          level_set  = false;
   int                           geo_level  = -1;
   int                           nbins      = 30;
-  int                           phi0       = M_PI / 2.;
+  int                           phi_bins   = 1;
+  int                           threads    = 0;
+  int                           n_origins  = 100;
+  int                           seed       = 1;
+  double                        sigma_x    = 0;
+  double                        sigma_y    = 0;
+  double                        sigma_z    = 3;
+  double                        crossing_angle = 25; // mrad
+  double                        phi0       = 0; // rad, the center of a single phi bin in scan mode
   bool                          list_all   = false;
   mode                          selected   = mode::list;
   int                           color      = 1;
@@ -58,34 +70,6 @@ struct settings {
 };
 //______________________________________________________________________________
 
-auto getMeanRadiationLength(std::string infile){
-  // Material Stats and the line of interest for eta = 0.3
-  // |     \   Material      Atomic                       Radiation   Interaction               Path   Integrated  Integrated    Material
-  // | Num. \  Name          Number/Z   Mass/A  Density    Length       Length    Thickness   Length      X0        Lambda      Endpoint  
-  // | Layer \                        [g/mole]  [g/cm3]     [cm]        [cm]          [cm]      [cm]     [cm]        [cm]     (     cm,     cm,     cm)
-  // | 0    Average Material    53     130.887  6.4748     1.1163     28.5924       41.096     41.10   36.815629   1.437312     ( 77.53, 120.75, 43.70)
-  std::ifstream file(infile);
-  std::string instr;
-  while(getline(file, instr)){
-    if (instr.find("Average")!=std::string::npos){
-      break;
-    }
-  }
-  // Lines have a variable number of spaces between the elements, this reduces them all to 1 space
-  for (int i = 10; i > 1; i--){
-    std::string emptyStr(i, ' ');
-    instr = std::regex_replace(instr, std::regex(emptyStr), " ");
-  }
-  
-  // Finds the Radiation length
-  std::stringstream ss(instr);
-  int count = 0;
-  while(getline(ss, instr, ' ') && count < 8){
-    count++;
-  }
-  return instr;
-}
-
 using namespace dd4hep::rec;
 
 template <typename T>
@@ -131,6 +115,18 @@ settings cmdline_settings(int argc, char* argv[]) {
                  "look at many different parts at once." %
                      command("scan").set(s.selected, mode::scan) &
                  value("variable", s.scan_var) % "variable to scan (either eta or theta)";
+  auto stackOpt = "stack mode does the eta-phi scan once and breaks the material down "
+                  "by every top-level subsystem (or the -d ones) into stacked histograms." %
+                      command("stack").set(s.selected, mode::stack);
+  auto vertexOpt = "vertex mode does the eta-phi scan from N origins sampled from the vertex "
+                   "distribution and reports the mean and RMS of the material per bin." % (
+                       command("vertex").set(s.selected, mode::vertex),
+                       option("--origins") & integer("N", s.n_origins) % "ray origins per direction (default 100)",
+                       option("--sigma-x") & number("cm", s.sigma_x) % "vertex spread in x [cm] (default 0)",
+                       option("--sigma-y") & number("cm", s.sigma_y) % "vertex spread in y [cm] (default 0)",
+                       option("--sigma-z") & number("cm", s.sigma_z) % "vertex spread in z [cm] (default 3)",
+                       option("--crossing-angle") & number("mrad", s.crossing_angle) % "beam crossing angle [mrad] (default 25)",
+                       option("--seed") & integer("seed", s.seed) % "random seed of the origins (default 1)");
   auto lineOpt = "line mode does a single extraction along a ray "
                  "defined by supplied variable value. " %
                      command("line").set(s.selected, mode::line) &
@@ -145,7 +141,11 @@ settings cmdline_settings(int argc, char* argv[]) {
        repeatable(option("-d", "--subsystem") & values("detector",s.subsystem_names).set(s.all_detectors,false) % "detector subsystem to include in the budget"),
        option("-h", "--help").set(s.selected, mode::help) % "show help",
        option("-n", "--n-bins") & integer("nbins", s.nbins) % "number of bins",
-       option("-o", "--output") & value("mat_budget.root", s.outfile) % "output root file"
+       option("--phi-bins") & integer("nphi", s.phi_bins) % "number of phi bins in scan mode",
+       option("--azimuth") & number("rad", s.phi0) % "azimuth of the ray in line and rad modes [rad] (default 0)",
+       option("-j", "--threads") & integer("threads", s.threads) % "scan threads (default: all cores)",
+       option("-o", "--output") & value("mat_budget.root", s.outfile) % "output root file",
+       option("--columns") & value("file", s.columns_file) % "also write the scan maps to a flat binary columnar file"
        );
 
   auto compactArg =  required("-c","--compact") & value("file", s.infile).if_missing([] {
@@ -153,7 +153,7 @@ settings cmdline_settings(int argc, char* argv[]) {
        }) % "compact detector description xml file";
 
   auto helpOpt = command("help").set(s.selected, mode::help) % "print help";
-  auto cli     = ((helpOpt | scanOpt | lineOpt | radOpt | lastOpt), compactArg);
+  auto cli     = ((helpOpt | scanOpt | stackOpt | vertexOpt | lineOpt | radOpt | lastOpt), compactArg);
 
   std::vector<std::string> wrong;
   assert(cli.flags_are_prefix_free());
@@ -276,6 +276,34 @@ int main(int argc, char* argv[]) {
   using ROOT::Math::Polar3DVector;
 
   Vector3D starting_point(0, 0, 0);
+
+  // Integrated material along a single line, per subsystem (or the whole world), stored in the TTree "line"
+  auto line_budgets = [&](double eta, const Vector3D& p0, const Vector3D& p1) {
+    std::vector<std::pair<std::string, npdet::mat::RayBudget>> budgets;
+    npdet::mat::ScanWorker worker(world);
+    if (good_subsystem_names.size() > 0) {
+      for (const auto& aname : good_subsystem_names) {
+        budgets.emplace_back(aname, worker.trace(p0, p1, npdet::mat::PlacementFilter(description.detector(aname))));
+      }
+    } else {
+      budgets.emplace_back("world", worker.trace(p0, p1));
+    }
+    auto        tree = new TTree("line", "Integrated material along the line");
+    std::string name;
+    npdet::mat::RayBudget budget;
+    tree->Branch("subsystem", &name);
+    tree->Branch("eta", &eta);
+    tree->Branch("x0", &budget.x0);
+    tree->Branch("lambda", &budget.lambda);
+    tree->Branch("length", &budget.length);
+    for (const auto& entry : budgets) {
+      std::tie(name, budget) = entry;
+      tree->Fill();
+    }
+    tree->ResetBranchAddresses();
+    return budgets;
+  };
+
   // Line Mode
   if (s.selected == mode::line) {
     double        eta   = s.line_val; // assuming only eta for now
@@ -298,10 +326,14 @@ int main(int argc, char* argv[]) {
     } else {
       ms.print(p0.x(), p0.y(), p0.z(), p1.x(), p1.y(), p1.z());
     }
+    for (const auto& [aname, budget] : line_budgets(eta, p0, p1)) {
+      fmt::print("{:<24} X/X0 = {:.5f}  lambda/l0 = {:.5f}  length = {:.3f} cm\n", aname, budget.x0, budget.lambda,
+                 budget.length);
+    }
   }
 
   // Rad Mode
-  // More or less a copy of line mode with some added functions
+  // Mean radiation length of the material along the line
   if( s.selected ==  mode::rad ) {
     double eta   = s.line_val; // assuming only eta for now
     double theta = 2.0 * std::atan(std::exp(-1.0 * eta));
@@ -309,56 +341,106 @@ int main(int argc, char* argv[]) {
 
     Vector3D p0 = starting_point;
     Vector3D p1 = starting_point + Vector3D(direction_step.x(), direction_step.y(), direction_step.z());
-    MaterialScan ms(description);
 
-    // const PlacementVec& placements = matMgr.placementsBetween(p0,p1);
-    // const MaterialVec& mats = matMgr.materialsBetween(p0,p1);
-    std::string tempFile = "temp_material_scan_file.txt";
-    if (!freopen(tempFile.c_str(), "w", stdout)) {
-      std::exit(-1);
+    for (const auto& [aname, budget] : line_budgets(eta, p0, p1)) {
+      double rad_length = budget.x0 > 0 ? budget.length / budget.x0 : 0;
+      fmt::print("{}: Average Radiation Length {:.4f} cm, X/X0 = {:.5f}\n", aname, rad_length, budget.x0);
     }
-    if (good_subsystem_names.size() > 0) {
-      for (const auto& aname : good_subsystem_names) {
-        //fmt::print(" Subsystem: {}\n", aname);
-        ms.setDetector(aname.c_str());
-        // const MaterialVec& mats = ms.scan(p0.x(),p0.y(),p0.z(),p1.x(),p1.y(),p1.z());
-        ms.print(p0.x(), p0.y(), p0.z(), p1.x(), p1.y(), p1.z());
+  }
+  
+  // Scan Mode and Stack Mode
+  if (s.selected == mode::scan || s.selected == mode::stack) {
+    npdet::mat::MapBinning binning;
+    binning.n_eta   = s.nbins;
+    binning.eta_min = s.eta_limits.at(0);
+    binning.eta_max = s.eta_limits.at(1);
+    binning.n_phi   = s.phi_bins;
+
+    std::vector<std::string> subsystems = good_subsystem_names;
+    if (s.selected == mode::stack && s.all_detectors) {
+      for (const auto& d : description.detectors()) {
+        subsystems.push_back(d.first);
+      }
+    }
+
+    // Rays are traced in parallel, one per eta-phi bin, and each step is
+    // attributed to its subsystem on the way: a single pass for all of them.
+    // The whole world goes to the top directory, each subsystem (and the
+    // rest, "other") to a directory of its own.
+    npdet::mat::SubsystemIndex index(description, subsystems);
+    auto slot_maps = npdet::mat::scan_maps(description, binning, starting_point, s.r_limits.at(1),
+                                           npdet::mat::thread_count(s.threads), index);
+    auto world_map = npdet::mat::total(slot_maps);
+    world_map.write(rootFile);
+
+    std::vector<std::pair<std::string, const npdet::mat::MaterialMap*>> maps = {{"world", &world_map}};
+    if (index.size() > 1) {
+      for (std::size_t k = 1; k <= index.size(); ++k) {
+        const std::size_t slot = k % index.size(); // "other" last
+        slot_maps[slot].write(rootFile->mkdir(index.name(slot).c_str()));
+        maps.emplace_back(index.name(slot), &slot_maps[slot]);
+      }
+      npdet::mat::write_stack(rootFile, {maps.begin() + 1, maps.end()});
+    }
+
+    fmt::print("{:>8} {:>8}", "eta", "theta");
+    for (const auto& [aname, map] : maps) {
+      fmt::print(" {:>16}", aname.substr(0, 16));
+    }
+    fmt::print("\n");
+    for (int i = 0; i < binning.n_eta; ++i) {
+      double eta   = binning.eta(i);
+      double theta = 2.0 * std::atan(std::exp(-1.0 * eta));
+      fmt::print("{:8.3f} {:8.4f}", eta, theta);
+      for (const auto& [aname, map] : maps) {
+        fmt::print(" {:16.5f}", map->mean_x0(i));
       }
+      fmt::print("\n");
     }
-    if (!freopen("/dev/tty", "w", stdout)) {
-      std::exit(-1);
+
+    if (!s.columns_file.empty()) {
+      if (!npdet::mat::write_columns(s.columns_file, maps)) {
+        fmt::print("Could not write {}\n", s.columns_file);
+        return 1;
+      }
     }
-    fmt::print("Average Radiation Length {}, full results in file {}.\n", getMeanRadiationLength(tempFile), tempFile);
   }
-  
-  // Scan Mode
-  if (s.selected == mode::scan) {
-    double d_eta = (s.eta_limits.at(1) - s.eta_limits.at(0)) / (s.nbins - 1);
-
-    for (int i = 0; i < s.nbins; ++i) {
-      double        eta   = s.eta_limits.at(0) + i * d_eta;
-      double        theta = 2.0 * std::atan(std::exp(-1.0 * eta));
-      Polar3DVector direction_step(s.r_limits.at(1), theta, s.phi0);
-
-      Vector3D p0 = starting_point;
-      Vector3D p1 = starting_point + Vector3D(direction_step.x(), direction_step.y(), direction_step.z());
-
-      // Material scan does all the heavy lifting.
-      // https://dd4hep.web.cern.ch/dd4hep/reference/classdd4hep_1_1rec_1_1MaterialScan.html#a1b6e0d33d679f87c476e5beca6a33717
-      MaterialScan ms(description);
-
-      // const PlacementVec& placements = matMgr.placementsBetween(p0,p1);
-      // const MaterialVec& mats = matMgr.materialsBetween(p0,p1);
-
-      if (s.subsystem_names.size() > 0) {
-        for (const auto& aname : s.subsystem_names) {
-          fmt::print(" Subsystem: {}\n", aname);
-          ms.setDetector(aname.c_str());
-          // const MaterialVec& mats = ms.scan(p0.x(),p0.y(),p0.z(),p1.x(),p1.y(),p1.z());
-          ms.print(p0.x(), p0.y(), p0.z(), p1.x(), p1.y(), p1.z());
-        }
+
+  // Vertex Mode
+  // The same directions as scan mode, each traced from every sampled vertex.
+  // The means go to the top directory, the RMS values to the directory "rms".
+  if (s.selected == mode::vertex) {
+    npdet::mat::MapBinning binning;
+    binning.n_eta   = s.nbins;
+    binning.eta_min = s.eta_limits.at(0);
+    binning.eta_max = s.eta_limits.at(1);
+    binning.n_phi   = s.phi_bins;
+
+    npdet::mat::VertexSpread vertex;
+    vertex.sigma_x        = s.sigma_x;
+    vertex.sigma_y        = s.sigma_y;
+    vertex.sigma_z        = s.sigma_z;
+    vertex.crossing_angle = s.crossing_angle * 1e-3;
+    auto origins = vertex.sample(starting_point, std::max(s.n_origins, 1), s.seed);
+
+    auto spread = npdet::mat::scan_spread(description, binning, origins, s.r_limits.at(1),
+                                          npdet::mat::thread_count(s.threads));
+    spread.mean.write(rootFile);
+    spread.rms.write(rootFile->mkdir("rms"));
+
+    fmt::print("{:>8} {:>8} {:>12} {:>12} {:>12} {:>12}\n", "eta", "theta", "X/X0", "RMS", "lambda/l0", "RMS");
+    for (int i = 0; i < binning.n_eta; ++i) {
+      double eta   = binning.eta(i);
+      double theta = 2.0 * std::atan(std::exp(-1.0 * eta));
+      fmt::print("{:8.3f} {:8.4f} {:12.5f} {:12.5f} {:12.5f} {:12.5f}\n", eta, theta, spread.mean.mean_x0(i),
+                 spread.rms.mean_x0(i), spread.mean.mean_lambda(i), spread.rms.mean_lambda(i));
+    }
+
+    if (!s.columns_file.empty()) {
+      if (!npdet::mat::write_columns(s.columns_file, {{"mean", &spread.mean}, {"rms", &spread.rms}})) {
+        fmt::print("Could not write {}\n", s.columns_file);
+        return 1;
       }
-      fmt::print(" {}  {} \n", eta, theta);
     }
   }
 
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2025 EIC Collaboration
+//
+// npdet_mat_grid: Voxelize the material of a detector into a regular
+// (x, y, z) grid once, and compare line integrals on the grid with the exact
+// navigation through the geometry.
+//
+// The grid file is named after the geometry hash, material_grid_<hash>.npgrid,
+// unless -g is given. build skips the work if that file already holds a grid
+// of the same geometry and binning. See npdet/MaterialGrid.h for the format
+// and the query interface.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TError.h"
+#include "TGeoMaterial.h"
+#include "DD4hep/Detector.h"
+#include "DD4hep/Printout.h"
+
+#include "npdet/MaterialGrid.h"
+#include "material_map.h"
+
+#include <fmt/core.h>
+#include "clipp.h"
+using namespace clipp;
+
+using npdet::mat::MaterialGrid;
+using npdet::mat::MaterialGridHeader;
+using npdet::mat::Vector3D;
+
+namespace {
+
+  enum class grid_mode { none, build, compare };
+
+  struct grid_settings {
+    bool                  success   = false;
+    bool                  help      = false;
+    grid_mode             selected  = grid_mode::none;
+    std::string           compact   = "";
+    std::string           grid_file = "";
+    std::array<int, 3>    bins      = {100, 100, 200};
+    std::array<double, 3> lo        = {-100, -100, -200};
+    std::array<double, 3> hi        = {100, 100, 200};
+    int                   samples   = 4;
+    int                   threads   = 0;
+    bool                  force     = false;
+    int                   nbins     = 30;
+    int                   phi_bins  = 8;
+    double                r_max     = 150;
+  };
+
+  using steady_clock = std::chrono::steady_clock;
+
+  double seconds_since(steady_clock::time_point start) {
+    return std::chrono::duration<double>(steady_clock::now() - start).count();
+  }
+
+  std::string grid_path(const grid_settings& s, std::uint64_t hash) {
+    return s.grid_file.empty() ? fmt::format("material_grid_{:016x}.npgrid", hash) : s.grid_file;
+  }
+
+  /// Average 1/X0 and 1/lambda per voxel from samples x samples lines along x through every (y, z) row of voxels
+  int build(const grid_settings& s, dd4hep::Detector& description) {
+    MaterialGridHeader header;
+    header.samples       = s.samples;
+    header.geometry_hash = npdet::mat::geometry_hash(description);
+    for (int a = 0; a < 3; ++a) {
+      header.nbins[a] = s.bins[a];
+      header.lo[a]    = s.lo[a];
+      header.hi[a]    = s.hi[a];
+    }
+    if (!header.valid() || s.samples < 1) {
+      fmt::print("Invalid grid: bins must be positive and min < max\n");
+      return 1;
+    }
+    const std::string  path = grid_path(s, header.geometry_hash);
+    MaterialGridHeader existing;
+    if (!s.force && MaterialGrid::read_header(path, existing) && existing.same_grid(header)) {
+      fmt::print("{} is up to date\n", path);
+      return 0;
+    }
+
+    const std::size_t   nx = s.bins[0], ny = s.bins[1], nz = s.bins[2];
+    const double        w[3] = {(s.hi[0] - s.lo[0]) / nx, (s.hi[1] - s.lo[1]) / ny, (s.hi[2] - s.lo[2]) / nz};
+    std::vector<float>  inv_x0(header.size()), inv_lambda(header.size());
+    const auto          start = steady_clock::now();
+    npdet::mat::parallel_for(description, npdet::mat::thread_count(s.threads), ny * nz,
+                             [&](npdet::mat::ScanWorker& worker, std::size_t row) {
+      const std::size_t   iy = row / nz, iz = row % nz;
+      std::vector<double> sum_x0(nx), sum_lambda(nx);
+      for (int a = 0; a < s.samples; ++a) {
+        for (int b = 0; b < s.samples; ++b) {
+          const double y = s.lo[1] + (iy + (a + 0.5) / s.samples) * w[1];
+          const double z = s.lo[2] + (iz + (b + 0.5) / s.samples) * w[2];
+          worker.steps(Vector3D(s.lo[0], y, z), Vector3D(s.hi[0], y, z),
+                       [&](const TGeoNode*, const TGeoMaterial* mat, double t, double step) {
+            const double end = t + step;
+            for (std::size_t ix = std::min<std::size_t>(t / w[0], nx); ix < nx && ix * w[0] < end; ++ix) {
+              const double overlap = std::min(end, (ix + 1) * w[0]) - std::max(t, ix * w[0]);
+              if (overlap > 0) {
+                sum_x0[ix] += overlap / mat->GetRadLen();
+                sum_lambda[ix] += overlap / mat->GetIntLen();
+              }
+            }
+          });
+        }
+      }
+      const double norm = 1.0 / (s.samples * s.samples * w[0]);
+      for (std::size_t ix = 0; ix < nx; ++ix) {
+        inv_x0[(ix * ny + iy) * nz + iz]     = sum_x0[ix] * norm;
+        inv_lambda[(ix * ny + iy) * nz + iz] = sum_lambda[ix] * norm;
+      }
+    });
+
+    if (!MaterialGrid::write(path, header, inv_x0.data(), inv_lambda.data())) {
+      fmt::print("Could not write {}\n", path);
+      return 1;
+    }
+    fmt::print("{}: {} voxels in {:.1f} s\n", path, header.size(), seconds_since(start));
+    return 0;
+  }
+
+  /// X/X0 from the origin along an eta-phi grid of rays, exact and on the grid
+  int compare(const grid_settings& s, dd4hep::Detector& description) {
+    const std::uint64_t hash = npdet::mat::geometry_hash(description);
+    const std::string   path = grid_path(s, hash);
+    MaterialGrid        grid(path);
+    if (grid.header().geometry_hash != hash) {
+      fmt::print("Warning: {} was built from a different geometry\n", path);
+    }
+
+    npdet::mat::MapBinning binning;
+    binning.n_eta = s.nbins;
+    binning.n_phi = s.phi_bins;
+    // Both integrals cover the part of each ray inside the grid
+    std::vector<Vector3D> p0(binning.size()), p1(binning.size());
+    for (int i = 0; i < binning.n_eta; ++i) {
+      for (int j = 0; j < binning.n_phi; ++j) {
+        const std::size_t bin   = binning.index(i, j);
+        const Vector3D    end   = s.r_max * binning.direction(i, j);
+        const double      a[3]  = {0, 0, 0};
+        const double      b[3]  = {end.x(), end.y(), end.z()};
+        double            t0    = 0, t1 = 0;
+        if (grid.clip(a, b, t0, t1)) {
+          p0[bin] = t0 * end;
+          p1[bin] = t1 * end;
+        }
+      }
+    }
+
+    std::vector<double> exact(binning.size()), voxel(binning.size());
+    const unsigned      n_threads = npdet::mat::thread_count(s.threads);
+    auto                start     = steady_clock::now();
+    npdet::mat::parallel_for(description, n_threads, binning.size(),
+                             [&](npdet::mat::ScanWorker& worker, std::size_t bin) {
+      exact[bin] = worker.trace(p0[bin], p1[bin]).x0;
+    });
+    const double t_exact = seconds_since(start);
+
+    start = steady_clock::now();
+    for (std::size_t bin = 0; bin < binning.size(); ++bin) {
+      const double a[3] = {p0[bin].x(), p0[bin].y(), p0[bin].z()};
+      const double b[3] = {p1[bin].x(), p1[bin].y(), p1[bin].z()};
+      voxel[bin]        = grid.integrate(a, b).x0;
+    }
+    const double t_grid = seconds_since(start);
+
+    fmt::print("{:>8} {:>12} {:>12} {:>10}\n", "eta", "exact X/X0", "grid X/X0", "rel. diff");
+    double sum_diff = 0, max_diff = 0;
+    int    n_diff   = 0;
+    for (int i = 0; i < binning.n_eta; ++i) {
+      double mean_exact = 0, mean_grid = 0;
+      for (int j = 0; j < binning.n_phi; ++j) {
+        const std::size_t bin = binning.index(i, j);
+        mean_exact += exact[bin] / binning.n_phi;
+        mean_grid += voxel[bin] / binning.n_phi;
+        if (exact[bin] > 1e-3) {
+          const double diff = std::abs(voxel[bin] - exact[bin]) / exact[bin];
+          sum_diff += diff;
+          max_diff = std::max(max_diff, diff);
+          ++n_diff;
+        }
+      }
+      fmt::print("{:8.3f} {:12.5f} {:12.5f} {:10.4f}\n", binning.eta(i), mean_exact, mean_grid,
+                 mean_exact > 0 ? (mean_grid - mean_exact) / mean_exact : 0.0);
+    }
+    fmt::print("Relative difference per ray (X/X0 > 0.001): mean {:.4f}, max {:.4f}\n",
+               n_diff > 0 ? sum_diff / n_diff : 0.0, max_diff);
+    fmt::print("Exact: {:.3f} ms per ray per thread ({} threads), grid: {:.2f} us per ray\n",
+               1e3 * t_exact * n_threads / binning.size(), n_threads, 1e6 * t_grid / binning.size());
+    return 0;
+  }
+
+  void print_usage(const group& cli, const char* argv0) {
+    std::cout << "Usage:\n" << usage_lines(cli, argv0)
+              << "\nOptions:\n" << documentation(cli) << '\n';
+  }
+
+  grid_settings cmdline_settings(int argc, char* argv[]) {
+    grid_settings s;
+    auto buildOpt = "build the grid unless it is up to date" % (
+      command("build").set(s.selected, grid_mode::build),
+      option("--bins") & integer("nx", s.bins[0]) & integer("ny", s.bins[1]) & integer("nz", s.bins[2])
+        % "number of voxels in x, y, z (default 100 100 200)",
+      option("--min") & number("x", s.lo[0]) & number("y", s.lo[1]) & number("z", s.lo[2])
+        % "lower grid edges [cm] (default -100 -100 -200)",
+      option("--max") & number("x", s.hi[0]) & number("y", s.hi[1]) & number("z", s.hi[2])
+        % "upper grid edges [cm] (default 100 100 200)",
+      option("-s", "--samples") & integer("samples", s.samples) % "sampling lines per voxel side (default 4)",
+      option("-f", "--force").set(s.force) % "rebuild even if the grid is up to date"
+    );
+    auto compareOpt = "compare X/X0 from the origin on the grid with the exact navigation" % (
+      command("compare").set(s.selected, grid_mode::compare),
+      option("-n", "--n-bins") & integer("nbins", s.nbins) % "number of eta bins in [-4, 4] (default 30)",
+      option("--phi-bins") & integer("nphi", s.phi_bins) % "number of phi bins (default 8)",
+      option("-r", "--r-max") & number("r", s.r_max) % "ray length [cm] (default 150)"
+    );
+    auto cli = (
+      (buildOpt | compareOpt | command("help").set(s.help)),
+      option("-h", "--help").set(s.help) % "show help",
+      option("-g", "--grid") & value("file", s.grid_file) % "grid file (default: named after the geometry hash)",
+      option("-j", "--threads") & integer("threads", s.threads) % "threads (default: all cores)",
+      required("-c", "--compact") & value("file", s.compact) % "compact detector description xml file"
+    );
+    assert(cli.flags_are_prefix_free());
+    auto res = parse(argc, argv, cli);
+    if (s.help) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    if (res.any_error() || s.selected == grid_mode::none) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    s.success = true;
+    return s;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  grid_settings s = cmdline_settings(argc, argv);
+  if (s.help) return 0;
+  if (!s.success) return 1;
+
+  dd4hep::setPrintLevel(dd4hep::ERROR);
+  gErrorIgnoreLevel = kError;
+
+  dd4hep::Detector& description = dd4hep::Detector::getInstance();
+  description.fromXML(s.compact);
+
+  try {
+    return s.selected == grid_mode::build ? build(s, description) : compare(s, description);
+  } catch (const std::exception& e) {
+    fmt::print("{}\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright (C) 2025 EIC Collaboration
+//
+// npdet_sanitize_hepmc3: Validate and repair HepMC3 ASCII event files.
+//
+// Does the same as scripts/sanitize_hepmc3.py:
+//   - checks the two header lines of the file,
+//   - drops events with more vertices than announced in the event record,
+//     or with a particle count different from the announced one,
+//   - adds the position of the first displaced vertex ("@ x y z t") to event
+//     records that do not have one,
+//   - drops unknown record types and everything after END_EVENT_LISTING,
+//     and appends END_EVENT_LISTING if it is missing.
+//
+// Regular files are memory-mapped and cut into chunks at event ('E') record
+// boundaries, which are sanitized in parallel. Other input (stdin, pipes) is
+// read in large blocks that are cut the same way. The output refers to the
+// input buffer wherever lines are passed through unchanged; only rewritten
+// event records are copied. The output is written in input order.
+//
+// To feed npsim without an intermediate file, write to a named pipe:
+//
+//     mkfifo events.hepmc3
+//     npdet_sanitize_hepmc3 input.hepmc3 -o events.hepmc3 &
+//     npsim --inputFiles events.hepmc3 ...
+//
+// or sanitize a decompressed stream:
+//
+//     xz -dc input.hepmc3.xz | npdet_sanitize_hepmc3 -o events.hepmc3 &
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "clipp.h"
+using namespace clipp;
+
+namespace {
+
+  constexpr std::string_view s_version = "HepMC::Version";
+  constexpr std::string_view s_start   = "HepMC::Asciiv3-START_EVENT_LISTING\n";
+  constexpr std::string_view s_end     = "HepMC::Asciiv3-END_EVENT_LISTING\n";
+
+  // Read block for non-seekable input
+  constexpr std::size_t s_block = 64 << 20;
+  // Smallest chunk handed to a worker
+  constexpr std::size_t s_min_chunk = 1 << 20;
+
+  struct sanitize_settings {
+    bool        success = false;
+    bool        help    = false;
+    std::string infile  = "-";
+    std::string outfile = "-";
+    unsigned    threads = std::max(1u, std::thread::hardware_concurrency());
+  };
+
+  /// Input file format errors, fatal as in sanitize_hepmc3.py
+  struct invalid_hepmc3 : std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  /// Line without its newline, for messages
+  std::string_view chomp(std::string_view line) {
+    return line.empty() || line.back() != '\n' ? line : line.substr(0, line.size() - 1);
+  }
+
+  /// Line starting at p, including its newline if there is one
+  std::string_view next_line(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return {p, static_cast<std::size_t>((nl ? nl + 1 : end) - p)};
+  }
+
+  /// Start of the first line in [begin, end) equal to line (which ends in a newline), or end
+  const char* find_line(const char* begin, const char* end, std::string_view line) {
+    std::string_view text(begin, end - begin);
+    for (std::size_t pos = text.find(line); pos != std::string_view::npos; pos = text.find(line, pos + 1)) {
+      if (pos == 0 || text[pos - 1] == '\n') return begin + pos;
+    }
+    return end;
+  }
+
+  /// Start of the first event record at or after p, or end
+  const char* find_event(const char* p, const char* begin, const char* end) {
+    if (p == begin && p != end && *p == 'E') return p;
+    std::string_view text(p, end - p);
+    const std::size_t pos = text.find("\nE");
+    return pos == std::string_view::npos ? end : p + pos + 1;
+  }
+
+  /// Start of the last event record in [begin, end) other than at begin, or begin
+  const char* find_last_event(const char* begin, const char* end) {
+    std::string_view text(begin, end - begin);
+    const std::size_t pos = text.rfind("\nE");
+    return pos == std::string_view::npos ? begin : begin + pos + 1;
+  }
+
+  /// Sanitized output of one chunk: views into the input and into rewritten event records
+  struct chunk_output {
+    std::vector<std::string_view> pieces;
+    std::deque<std::string>       owned;
+    std::string                   warnings;
+    std::size_t                   events  = 0;
+    std::size_t                   skipped = 0;
+    std::exception_ptr            error;
+    // Pieces before this index are not extended by append()
+    std::size_t                   barrier = 0;
+
+    void append(std::string_view s) {
+      if (pieces.size() > barrier && pieces.back().data() + pieces.back().size() == s.data()) {
+        pieces.back() = {pieces.back().data(), pieces.back().size() + s.size()};
+      } else {
+        pieces.push_back(s);
+      }
+    }
+    void warn(std::string_view a, std::string_view b = {}, std::string_view c = {}) {
+      warnings.append("WARNING: ").append(a).append(b).append(c).append("\n");
+    }
+  };
+
+  /// Event being collected: its record and the counts checked against it
+  struct event_state {
+    std::string_view raw;
+    std::string_view vertex;
+    long             n_vertices = 0, n_particles = 0;
+    long             vert_cnt = 0, part_cnt = 0;
+    std::size_t      first_piece = 0;
+  };
+
+  /// Text after the first '@' up to the next one, as line.split('@')[1] in the script
+  std::string_view vertex_of(std::string_view line) {
+    const std::size_t at = line.find('@');
+    if (at == std::string_view::npos) return {};
+    const std::string_view rest = line.substr(at + 1);
+    return rest.substr(0, rest.find('@'));
+  }
+
+  long field(std::string_view line, int index) {
+    std::size_t pos = 0;
+    for (int i = 0; i < index; ++i) {
+      pos = line.find(' ', pos);
+      if (pos == std::string_view::npos) throw invalid_hepmc3("Invalid event record: " + std::string(chomp(line)));
+      ++pos;
+    }
+    long value = 0;
+    const char* first = line.data() + pos;
+    const char* last  = line.data() + line.size();
+    const auto [ptr, ec] = std::from_chars(first, last, value);
+    if (ec != std::errc() || (ptr != last && *ptr != ' ' && *ptr != '\n' && *ptr != '\r')) {
+      throw invalid_hepmc3("Invalid event record: " + std::string(chomp(line)));
+    }
+    return value;
+  }
+
+  /// Keep or drop the collected event, rewriting its record if it lacks the vertex
+  void finish_event(const event_state& ev, chunk_output& out) {
+    ++out.events;
+    const char* reason = nullptr;
+    if (ev.vert_cnt > ev.n_vertices) {
+      reason = "Too many vertices for event: ";
+    } else if (ev.part_cnt != ev.n_particles) {
+      reason = "Invalid particle count for event: ";
+    }
+    if (reason) {
+      out.warn(reason, chomp(ev.raw), " --> skipping event");
+      out.warn("Skipped invalid event ", chomp(ev.raw));
+      out.pieces.resize(ev.first_piece);
+      out.barrier = out.pieces.size();
+      ++out.skipped;
+      return;
+    }
+    if (!ev.vertex.empty() && ev.raw.find('@') == std::string_view::npos) {
+      std::string record(chomp(ev.raw));
+      record.append(" @").append(ev.vertex);
+      if (record.back() != '\n') record.push_back('\n');
+      out.owned.push_back(std::move(record));
+      out.pieces[ev.first_piece] = out.owned.back();
+    }
+  }
+
+  /// Sanitize the records in [begin, end), which ends at an event record or at the end of the events
+  void sanitize(const char* begin, const char* end, chunk_output& out) {
+    event_state ev;
+    bool        in_event = false;
+    for (const char* p = begin; p != end;) {
+      const std::string_view line = next_line(p, end);
+      p += line.size();
+      switch (line[0]) {
+      case 'A':
+      case 'W':
+      case 'T':
+      case 'N':
+        out.append(line);
+        break;
+      case 'E':
+        if (in_event) finish_event(ev, out);
+        ev             = event_state();
+        ev.raw         = line;
+        ev.vertex      = vertex_of(line);
+        ev.n_vertices  = field(line, 2);
+        ev.n_particles = field(line, 3);
+        ev.first_piece = out.pieces.size();
+        out.pieces.push_back(line);
+        out.barrier = out.pieces.size();
+        in_event    = true;
+        break;
+      default:
+        if (!in_event) {
+          throw invalid_hepmc3("Encountered invalid field before the first Event header: " +
+                               std::string(chomp(line)));
+        }
+        if (line[0] == 'V') {
+          if (++ev.vert_cnt > ev.n_vertices) {
+            out.warn("Too many vertices for event: ", chomp(ev.raw));
+          } else if (ev.vertex.empty()) {
+            ev.vertex = vertex_of(line);
+          }
+        } else if (line[0] == 'P') {
+          if (++ev.part_cnt > ev.n_particles) {
+            out.warn("Too many particles for event: ", chomp(ev.raw));
+          }
+        } else if (line[0] != 'U') {
+          out.warn("Ignoring unknown field: ", chomp(line));
+          continue;
+        }
+        out.append(line);
+      }
+    }
+    if (in_event) finish_event(ev, out);
+  }
+
+  /// Sanitize [begin, end) in parallel chunks cut at event records
+  std::vector<chunk_output> sanitize_parallel(const char* begin, const char* end, unsigned threads) {
+    const std::size_t  size  = end - begin;
+    const std::size_t  chunk = std::max(s_min_chunk, size / (4 * threads) + 1);
+    std::vector<const char*> cuts{begin};
+    while (cuts.back() != end) {
+      const char* target = cuts.back() + std::min(chunk, static_cast<std::size_t>(end - cuts.back()));
+      cuts.push_back(target == end ? end : find_event(target, begin, end));
+    }
+
+    std::vector<chunk_output> outputs(cuts.size() - 1);
+    std::atomic<std::size_t>  next{0};
+    auto work = [&]() {
+      for (std::size_t i = next++; i < outputs.size(); i = next++) {
+        try {
+          sanitize(cuts[i], cuts[i + 1], outputs[i]);
+        } catch (...) {
+          outputs[i].error = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < std::min<std::size_t>(threads, outputs.size()); ++t) {
+      pool.emplace_back(work);
+    }
+    work();
+    for (auto& t : pool) t.join();
+    return outputs;
+  }
+
+  /// Write all pieces to fd with as few system calls as possible
+  void write_all(int fd, const std::vector<std::string_view>& pieces) {
+    std::vector<iovec> iov;
+    iov.reserve(std::min<std::size_t>(pieces.size(), IOV_MAX));
+    std::size_t i = 0;
+    while (i < pieces.size()) {
+      iov.clear();
+      for (; i < pieces.size() && iov.size() < IOV_MAX; ++i) {
+        if (!pieces[i].empty()) iov.push_back({const_cast<char*>(pieces[i].data()), pieces[i].size()});
+      }
+      std::size_t first = 0;
+      while (first < iov.size()) {
+        const ssize_t n = ::writev(fd, iov.data() + first, static_cast<int>(iov.size() - first));
+        if (n < 0) {
+          if (errno == EINTR) continue;
+          throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        // Skip what was written, resuming partial writes inside a piece
+        for (std::size_t left = n; left > 0;) {
+          if (left >= iov[first].iov_len) {
+            left -= iov[first].iov_len;
+            ++first;
+          } else {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+            left = 0;
+          }
+        }
+      }
+    }
+  }
+
+  /// Running totals and the output of the whole file
+  struct sanitizer {
+    int         fd;
+    unsigned    threads;
+    std::size_t events  = 0;
+    std::size_t skipped = 0;
+    bool        end_reached = false;
+    std::size_t ignored = 0;
+
+    /// Check the two header lines at the start of text and write them; returns their length
+    std::size_t header(std::string_view text) {
+      const std::string_view first = next_line(text.data(), text.data() + text.size());
+      if (first.find(s_version) == std::string_view::npos) {
+        throw invalid_hepmc3("Not a valid HepMC3 file header: " + std::string(chomp(first)));
+      }
+      const std::string_view second = next_line(text.data() + first.size(), text.data() + text.size());
+      if (second != s_start) {
+        throw invalid_hepmc3("Not a valid HepMC3 file header: " + std::string(chomp(second)));
+      }
+      write_all(fd, {first, second});
+      return first.size() + second.size();
+    }
+
+    /// Sanitize and write [begin, end); stops at END_EVENT_LISTING and counts any lines after it
+    void events_in(const char* begin, const char* end) {
+      if (end_reached) {
+        ignored += std::count(begin, end, '\n');
+        return;
+      }
+      const char* stop = find_line(begin, end, s_end);
+      for (auto& out : sanitize_parallel(begin, stop, threads)) {
+        write_all(fd, out.pieces);
+        std::cerr << out.warnings;
+        events += out.events;
+        skipped += out.skipped;
+        if (out.error) std::rethrow_exception(out.error);
+      }
+      if (stop != end) {
+        end_reached = true;
+        ignored += std::count(stop + s_end.size(), end, '\n');
+      }
+    }
+
+    /// Close the event listing
+    void finish() {
+      if (ignored > 0) {
+        std::cerr << "WARNING: Ignoring " << ignored << " lines after END_EVENT_LISTING was reached\n";
+      }
+      if (!end_reached) {
+        std::cerr << "WARNING: File does not end with END_EVENT_LISTING, appending\n";
+      }
+      write_all(fd, {s_end});
+    }
+  };
+
+  /// Memory-map a regular file and sanitize it in one pass
+  void sanitize_mapped(int in, std::size_t size, sanitizer& s) {
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in, 0);
+    if (data == MAP_FAILED) throw std::runtime_error(std::string("mmap failed: ") + std::strerror(errno));
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    const char* begin = static_cast<const char*>(data);
+    try {
+      const std::size_t skip = s.header({begin, size});
+      s.events_in(begin + skip, begin + size);
+    } catch (...) {
+      ::munmap(data, size);
+      throw;
+    }
+    ::munmap(data, size);
+  }
+
+  /// Read a stream in blocks and sanitize all complete events of each block
+  void sanitize_stream(int in, sanitizer& s) {
+    std::vector<char> buffer;
+    std::size_t       used = 0, start = 0;
+    bool              eof = false, have_header = false;
+    while (!eof) {
+      if (buffer.size() - used < s_block) buffer.resize(used + s_block);
+      const ssize_t n = ::read(in, buffer.data() + used, buffer.size() - used);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+      }
+      eof = n == 0;
+      used += n;
+      const char* data = buffer.data();
+      if (!have_header) {
+        // Wait for both header lines
+        const char* nl = static_cast<const char*>(std::memchr(data, '\n', used));
+        if (!eof && (!nl || !std::memchr(nl + 1, '\n', data + used - nl - 1))) continue;
+        start       = s.header({data, used});
+        have_header = true;
+      }
+      // Everything up to the last event record is complete
+      const char* cut = eof ? data + used : find_last_event(data + start, data + used);
+      if (cut == data + start && !eof) continue;
+      s.events_in(data + start, cut);
+      const std::size_t rest = data + used - cut;
+      std::memmove(buffer.data(), cut, rest);
+      used  = rest;
+      start = 0;
+    }
+  }
+
+  void print_usage(const group& cli, const char* argv0) {
+    std::cout << "Usage:\n" << usage_lines(cli, argv0)
+              << "\nOptions:\n" << documentation(cli) << '\n';
+  }
+
+  sanitize_settings cmdline_settings(int argc, char* argv[]) {
+    sanitize_settings s;
+    auto cli = (
+      option("-h", "--help").set(s.help) % "show help",
+      option("-o", "--output") & value("out", s.outfile)
+        % "Output file or named pipe (default: stdout)",
+      option("-j", "--threads") & integer("n", s.threads)
+        % "Number of worker threads (default: number of cores)",
+      opt_value("file", s.infile) % "HepMC3 ASCII input file (default: stdin)"
+    );
+    assert(cli.flags_are_prefix_free());
+    auto res = parse(argc, argv, cli);
+    if (s.help) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    if (res.any_error() || s.threads == 0) {
+      print_usage(cli, argv[0]);
+      return s;
+    }
+    s.success = true;
+    return s;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  sanitize_settings settings = cmdline_settings(argc, argv);
+  if (settings.help) return 0;
+  if (!settings.success) return 1;
+
+  const int in = settings.infile == "-" ? STDIN_FILENO : ::open(settings.infile.c_str(), O_RDONLY);
+  if (in < 0) {
+    std::cerr << "Cannot open input file: " << settings.infile << "\n";
+    return 1;
+  }
+  const int out = settings.outfile == "-" ? STDOUT_FILENO
+                                          : ::open(settings.outfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out < 0) {
+    std::cerr << "Cannot open output file: " << settings.outfile << "\n";
+    return 1;
+  }
+
+  sanitizer s{out, settings.threads};
+  try {
+    struct stat st;
+    if (::fstat(in, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      sanitize_mapped(in, st.st_size, s);
+    } else {
+      sanitize_stream(in, s);
+    }
+    s.finish();
+  } catch (const invalid_hepmc3& e) {
+    std::cerr << "InvalidHepmc3Error: " << e.what() << "\n";
+    return 1;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  if (s.skipped > 0) {
+    std::cerr << "Skipped " << s.skipped << " of " << s.events << " events\n";
+  }
+  if (out != STDOUT_FILENO) ::close(out);
+  if (in != STDIN_FILENO) ::close(in);
+  return 0;
+}
@@ -0,0 +1,184 @@
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+// Compares npdet_sanitize_hepmc3 with scripts/sanitize_hepmc3.py, which it
+// replaces: both must produce the same output for the same input, whether the
+// tool reads a mapped file or a pipe.
+//
+// NPDET_SANITIZE_HEPMC3, SANITIZE_HEPMC3_SCRIPT and PYTHON_EXECUTABLE are set
+// by CMake.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+  const std::string s_header = "HepMC::Version 3.02.02\nHepMC::Asciiv3-START_EVENT_LISTING\n";
+  const std::string s_end    = "HepMC::Asciiv3-END_EVENT_LISTING\n";
+
+  std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("npdet_sanitize_" + name)).string();
+  }
+
+  void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+  }
+
+  std::string readFile(const std::string& path) {
+    std::ifstream      in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+  }
+
+  /// Exit status of a shell command
+  int run(const std::string& command) {
+    const int status = std::system(command.c_str());
+    return status == 0 ? 0 : 1;
+  }
+
+  std::string quoted(const std::string& s) { return "'" + s + "'"; }
+
+  /// Outputs of the script and of the tool on the same input
+  struct Outputs {
+    int         script_status = 0, file_status = 0, pipe_status = 0;
+    std::string script, file, pipe;
+  };
+
+  Outputs sanitize(const std::string& name, const std::string& input) {
+    const std::string in = tempPath(name + ".hepmc3");
+    writeFile(in, input);
+    Outputs out;
+    out.script_status = run(quoted(PYTHON_EXECUTABLE) + " " + quoted(SANITIZE_HEPMC3_SCRIPT) + " < " + quoted(in) +
+                            " > " + quoted(in + ".py") + " 2> /dev/null");
+    out.file_status   = run(quoted(NPDET_SANITIZE_HEPMC3) + " -j 4 " + quoted(in) + " -o " + quoted(in + ".file") +
+                          " 2> /dev/null");
+    out.pipe_status   = run("cat " + quoted(in) + " | " + quoted(NPDET_SANITIZE_HEPMC3) + " -j 4 > " +
+                          quoted(in + ".pipe") + " 2> /dev/null");
+    out.script        = readFile(in + ".py");
+    out.file          = readFile(in + ".file");
+    out.pipe          = readFile(in + ".pipe");
+    for (const char* suffix : {"", ".py", ".file", ".pipe"}) {
+      std::filesystem::remove(in + suffix);
+    }
+    return out;
+  }
+
+  /// Event with n_vertices vertices and n_particles particles; the first vertex is displaced if displaced is set
+  std::string event(int number, int n_vertices, int n_particles, bool displaced = false, int announced_vertices = -1,
+                    int announced_particles = -1) {
+    std::ostringstream e;
+    e << "E " << number << " " << (announced_vertices < 0 ? n_vertices : announced_vertices) << " "
+      << (announced_particles < 0 ? n_particles : announced_particles) << "\n";
+    e << "U GEV MM\n";
+    e << "W 1.0\n";
+    e << "A 0 signal_process_id 99\n";
+    for (int p = 1; p <= n_particles; ++p) {
+      e << "P " << p << " " << (p <= 2 ? 0 : -1) << " " << (p % 2 ? 2212 : 11) << " 0.1 -0.2 " << 10. * p << " "
+        << 10. * p + 0.5 << " 0.000511 " << (p <= 2 ? 4 : 1) << "\n";
+      if (p == 2) {
+        for (int v = 1; v <= n_vertices; ++v) {
+          e << "V -" << v << " 0 [1,2]";
+          if (displaced && v == 1) {
+            e << " @ 0.15 -0.3 " << 1.5 * number << " 0.25";
+          }
+          e << "\n";
+        }
+      }
+    }
+    return e.str();
+  }
+
+} // namespace
+
+TEST_CASE("Valid events are passed through", "[sanitize_hepmc3]") {
+  const auto out = sanitize("valid", s_header + event(0, 1, 4) + event(1, 2, 5) + s_end);
+  REQUIRE(out.script_status == 0);
+  REQUIRE(out.file_status == 0);
+  REQUIRE(out.pipe_status == 0);
+  CHECK(out.file == out.script);
+  CHECK(out.pipe == out.script);
+}
+
+TEST_CASE("Displaced vertices are added to the event record", "[sanitize_hepmc3]") {
+  const std::string with_position = "E 2 1 3 @ 1 2 3 4\nU GEV MM\nP 1 0 2212 0 0 1 1 0.9 4\nP 2 0 11 0 0 -1 1 0 4\n"
+                                    "V -1 0 [1,2] @ 5 6 7 8\nP 3 -1 11 0 0 1 1 0 1\n";
+  const auto out = sanitize("displaced", s_header + event(0, 1, 4, true) + event(1, 2, 3, true) + with_position + s_end);
+  REQUIRE(out.script_status == 0);
+  REQUIRE(out.file_status == 0);
+  CHECK(out.file == out.script);
+  CHECK(out.pipe == out.script);
+  CHECK(out.file.find("E 0 1 4 @ 0.15 -0.3 0 0.25\n") != std::string::npos);
+  CHECK(out.file.find("E 2 1 3 @ 1 2 3 4\n") != std::string::npos);
+}
+
+TEST_CASE("Events with wrong counts are dropped", "[sanitize_hepmc3]") {
+  const std::string input = s_header + event(0, 1, 4) + event(1, 3, 4, false, 2) + event(2, 1, 4, false, -1, 5) +
+                            event(3, 1, 4, false, -1, 3) + event(4, 1, 3) + s_end;
+  const auto out = sanitize("counts", input);
+  REQUIRE(out.script_status == 0);
+  REQUIRE(out.file_status == 0);
+  CHECK(out.file == out.script);
+  CHECK(out.pipe == out.script);
+  CHECK(out.file.find("E 1 ") == std::string::npos);
+  CHECK(out.file.find("E 4 ") != std::string::npos);
+}
+
+TEST_CASE("Unknown records, run information and the end of the listing", "[sanitize_hepmc3]") {
+  const std::string run_info = "W weight1 weight2\nN 2 \"nominal\" \"variation\"\nT pythia8 8.310 \"generator\"\n";
+  const std::string unknown  = "X this record is not known\n";
+  SECTION("unknown record types are dropped") {
+    const auto out = sanitize("unknown", s_header + run_info + event(0, 1, 4) + unknown + event(1, 1, 3) + s_end);
+    REQUIRE(out.file_status == 0);
+    CHECK(out.file == out.script);
+    CHECK(out.pipe == out.script);
+  }
+  SECTION("lines after the end of the listing are ignored") {
+    const auto out = sanitize("trailing", s_header + event(0, 1, 4) + s_end + event(1, 1, 3));
+    REQUIRE(out.file_status == 0);
+    CHECK(out.file == out.script);
+    CHECK(out.pipe == out.script);
+  }
+  SECTION("a missing end of the listing is appended") {
+    const auto out = sanitize("unterminated", s_header + event(0, 1, 4) + event(1, 1, 3));
+    REQUIRE(out.file_status == 0);
+    CHECK(out.file == out.script);
+    CHECK(out.pipe == out.script);
+  }
+}
+
+TEST_CASE("Many events are split across threads in input order", "[sanitize_hepmc3]") {
+  // Several MB, so the mapped file is cut into chunks for all four threads
+  std::string input = s_header;
+  for (int i = 0; input.size() < (6u << 20); ++i) {
+    if (i % 97 == 13) {
+      input += event(i, 2, 6, true, 1);
+    } else {
+      input += event(i, 1 + i % 3, 8 + i % 5, i % 7 == 0);
+    }
+  }
+  input += s_end;
+  const auto out = sanitize("many", input);
+  REQUIRE(out.script_status == 0);
+  REQUIRE(out.file_status == 0);
+  REQUIRE(out.pipe_status == 0);
+  CHECK(out.file == out.script);
+  CHECK(out.pipe == out.script);
+}
+
+TEST_CASE("Invalid files are rejected", "[sanitize_hepmc3]") {
+  for (const auto& [name, input] :
+       {std::pair<std::string, std::string>{"version", "HepMC2\n" + s_header.substr(23) + event(0, 1, 4) + s_end},
+        {"start", s_header.substr(0, 23) + "HepMC::IO_GenEvent-START_EVENT_LISTING\n" + event(0, 1, 4) + s_end},
+        {"orphan", s_header + "P 1 0 2212 0 0 1 1 0.9 4\n" + event(0, 1, 4) + s_end}}) {
+    INFO(name);
+    const auto out = sanitize(name, input);
+    CHECK(out.script_status != 0);
+    CHECK(out.file_status != 0);
+    CHECK(out.pipe_status != 0);
+  }
+}